@@ -0,0 +1,52 @@
+/*
+ * File:            appcmd.h
+ * Author:          Thomas Jerman
+ * Date Created:    18.10.2026
+ * Version: 1.0:    DD.MM.YYYY
+ * Last Modified:   DD.MM.YYYY
+ *
+ * Description:
+ * Providing the application commands
+ *
+ * License:
+ * This code is released under Creative Commons Legal Code CC0 1.0 Universal
+ *
+ * Contact:
+ * jr@htl-kaindorf.at
+ */
+
+#ifndef APPCMD_H_INCLUDED
+#define APPCMD_H_INCLUDED
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/****************************************************/
+// GLOBAL DEFINES
+/****************************************************/
+
+/****************************************************/
+// GLOBAL STRUCT DEFINITION
+/****************************************************/
+
+/****************************************************/
+// GLOBAL STRUCT VARIABLE DECLARATION, INIT
+/****************************************************/
+
+/****************************************************/
+// GLOBAL MACROS
+/****************************************************/
+
+/****************************************************/
+// GLOBAL FUNCTIONS
+/****************************************************/
+
+// Register the application command table using cmdSetApplicationCommands
+void appCmdRegister();
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
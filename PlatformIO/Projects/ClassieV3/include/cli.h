@@ -6,7 +6,9 @@
  * Last Modified:   10.03.2024
  *
  * Description:
- * Providing a Command Line Interface using the AVR-UART
+ * Providing a Command Line Interface using the AVR-UART. Up to CLI_INSTANCES independent shells, each with
+ * its own buffers, prompt, history and interrupt-driven USART, the CLI functions work on the one selected
+ * by cliSelect()
  *
  * License:
  * This code is released under Creative Commons Legal Code CC0 1.0 Universal
@@ -31,7 +33,40 @@ extern "C" {
 #define HIST_BUFFER_PRINTING
 #define CURSOR_HIDING
 
-#define REC_CHAR_MAX                0x1F    // only 0x1F or 0x3F possible
+// USARTs the CLI can be bound to: USART0 to USART3 on the ATmega2560, USART0 on the ATmega328P
+#if defined(UDR3)
+#define CLI_USARTS                  4
+#else
+#define CLI_USARTS                  1
+#endif
+
+// Independent shells, each with its own buffers, prompt, history and USART, e.g. -DCLI_INSTANCES=2
+#ifndef CLI_INSTANCES
+#define CLI_INSTANCES               1
+#endif
+
+#if CLI_INSTANCES < 1 || CLI_INSTANCES > CLI_USARTS
+#error "CLI_INSTANCES must be at least 1 and must not exceed the number of USARTs"
+#endif
+
+#define REC_CHAR_MAX                0x3F    // maximum characters of a command line, only 0x1F or 0x3F possible
+#define RX_BUF_SIZE                 128     // size of the UART receive ring buffer, power of two up to 512
+#define TX_BUF_SIZE                 128     // size of the UART transmit ring buffer, power of two up to 256
+#define TOKENS_MAX                  8       // maximum number of tokens (command and parameters) per command line
+#define CLI_HIST_ENTRIES            8       // maximum number of commands in the history
+#define CLI_HIST_SIZE               128     // bytes of the history buffer, up to 255
+
+#define CLI_STATUS_BAR_WIDTH        79      // characters of a status bar row
+#define CLI_STATUS_LABEL_SIZE       28      // maximum status field label length + 1
+#define CLI_STATUS_VALUE_SIZE       16      // maximum status field value width + 1
+#define CLI_STATUS_SHADOW_SIZE      64      // sum of all status field value widths
+#define CLI_STATUS_BAR_REACH        23      // maximum lines between the status bar and the prompt for updates
+#define CLI_STATUS_INTERVAL         500     // default minimum time between two status bar updates in ms
+
+#define CLI_BINARY_MAGIC            "\x1C\x1D\x1E\x1F"  // distinct control characters switching to the binary protocol
+
+#define TX_NON_BLOCKING             0       // drop characters while the transmit ring buffer is full
+#define TX_BLOCKING                 1       // wait for free space while the transmit ring buffer is full
 
 // Supported ASCII CTRL-Characters by Serial Monitor (VSC) and PuTTY, source: https://www.physics.udel.edu/~watson/scen103/ascii.html
 #define CTRL_A                      0x01    // Start of heading
@@ -136,6 +171,10 @@ extern "C" {
 #define HIDE_CURSOR                 "\e[?25l"
 #define CURSOR_TO_UPPER_LEFT_POS    "\e[H"
 #define CLEAR_SCREEN                "\e[2J\e[H" // Clear screen and move Curosor to upper left position
+#define CLEAR_TO_SCREEN_END         "\e[J"
+#define SAVE_CURSOR                 "\e7"   // DECSC: save cursor position and text format
+#define RESTORE_CURSOR              "\e8"   // DECRC: restore cursor position and text format
+#define RESET_SCROLL_REGION         "\e[r"  // DECSTBM without parameters: the whole screen scrolls
 
 #define HIDE_CURSOR_ON              1
 #define HIDE_CURSOR_OFF             0
@@ -147,6 +186,27 @@ extern "C" {
 // GLOBAL STRUCT DEFINITION
 /****************************************************/
 
+// Descriptor of a token (command or parameter) within the received command line
+struct CliToken
+{
+    uint8_t offset;                     // position of the first token character in the command line
+    uint8_t length;                     // number of token characters, without quotes
+    uint8_t quoted;                     // 1 if the token was enclosed in quotes
+};
+
+// Status bar field stored in program memory: label followed by a value of fixed width
+// A field without format function (NULL) and width 0 only prints its label
+struct CliStatusField
+{
+    char label[CLI_STATUS_LABEL_SIZE];  // text printed in front of the value
+    uint8_t row;                        // status bar row, 0 = first row
+    uint8_t column;                     // column of the label, 0 = leftmost column
+    uint8_t width;                      // characters of the value, shorter values are padded with spaces
+    void (*format)(char *buffer, uint8_t size, uint8_t arg);   // writes the value as '\0' terminated string into
+                                                                // CLI_STATUS_VALUE_SIZE bytes, cut to width
+    uint8_t arg;                        // handed over to format, e.g. an index
+};
+
 /****************************************************/
 // GLOBAL STRUCT VARIABLE DECLARATION, INIT
 /****************************************************/
@@ -163,6 +223,68 @@ extern "C" {
 // using 8 bit data and 2 stop bit for timing considerations
 void cliInit(uint32_t bps);
 
+// Initialize the CLI instance bound to USART usart (0 to CLI_USARTS - 1) with custom bitrate and select it,
+// cliInit() initializes instance 0 bound to USART0
+void cliInitInstance(uint8_t instance, uint8_t usart, uint32_t bps);
+
+// Select the initialized CLI instance all other CLI functions work on and connect stdout to its USART
+void cliSelect(uint8_t instance);
+
+// Get the CLI instance selected
+uint8_t cliGetInstance();
+
+// Set the policy for writing to a full transmit ring buffer: TX_BLOCKING or TX_NON_BLOCKING
+void cliSetTxPolicy(unsigned char txPolicy);
+
+// Get the number of characters waiting in the transmit ring buffer
+unsigned int cliGetTxPending();
+
+// Get the number of received characters waiting in the receive ring buffer
+unsigned int cliGetRxPending();
+
+// Read a byte of the receive ring buffer bypassing the command line editing, used by the binary protocol
+// Return value:    1: byte read
+//                  0: receive ring buffer empty
+uint8_t cliReadByte(uint8_t *byte);
+
+// Get the number of characters dropped due to a full transmit ring buffer
+unsigned int cliGetTxDropped();
+
+// Switch to the binary protocol (1), text output is dropped, or back to the command line (0)
+void cliSetBinaryMode(uint8_t enable);
+
+// Get if the binary protocol owns the USART, entered on receiving CLI_BINARY_MAGIC
+uint8_t cliIsBinaryMode();
+
+// Write length bytes of a binary protocol frame into the transmit ring buffer, text output stays dropped
+void cliWriteBinary(const void *data, uint8_t length);
+
+// Wait until all characters in the transmit ring buffer have been handed over to the UART
+void cliFlushTx();
+
+// Write length characters straight into the transmit ring buffer, bypassing stdout
+// Line feeds are counted like those printed through stdout
+void cliWrite(const char *data, uint8_t length);
+
+// Get the number of tokens (command and parameters) of the received command line
+uint8_t cliGetArgc();
+
+// Get token by index as '\0' terminated string: index 0 = command, 1.. = parameters
+// Strings under quotes are one single token. Return value: NULL if index >= cliGetArgc()
+char *cliGetArgv(uint8_t index);
+
+// Get the descriptor (offset, length, quoted) of the token at index
+// Return value: NULL if index >= cliGetArgc()
+const struct CliToken *cliGetToken(uint8_t index);
+
+// Set the command line to length characters received by other means than typing, e.g. by the binary
+// protocol, and split it into tokens, characters beyond REC_CHAR_MAX are ignored
+void cliSetCommandLine(const char *line, uint8_t length);
+
+// Drop the first count tokens, so the token at index count becomes the command
+// Return value: number of tokens left
+uint8_t cliShiftArgv(uint8_t count);
+
 // Get first token (spaced separated substring) from reveived string
 char *cliGetFirstToken();
 
@@ -199,6 +321,21 @@ char cliGetCtrlKey();
 // Clear Command History
 void cliClearCmdHistory();
 
+// Append a command of length characters to the history, an identical older command is removed
+// The oldest commands are dropped while CLI_HIST_ENTRIES or CLI_HIST_SIZE would be exceeded
+void cliAddHistoryEntry(const char *command, uint8_t length);
+
+// Get the number of commands in the history
+uint8_t cliGetHistoryCount();
+
+// Get a command of the history without '\0', index 0 is the oldest command
+// Return value:    pointer to the command, its number of characters is written to length
+//                  NULL if index is out of range
+const char *cliGetHistoryEntry(uint8_t index, uint8_t *length);
+
+// Get a counter incremented on each change of the history, e.g. to detect commands to be saved
+uint8_t cliGetHistoryChanges();
+
 // Hide Cursor
 void cliHideCursor();
 
@@ -214,6 +351,32 @@ unsigned char cliGetStatusBarFlag();
 // Set the function pointer to the user implemented status bar setup function
 void cliSetStatusBar(void (*userStatusBarSetup)(void));
 
+// Set the status bar fields stored in program memory (PROGMEM) replacing the status bar setup function
+// Only fields whose value changed are redrawn by cliPrintStatusBar()
+// Return value:    1: fields set
+//                  0: fields exceed CLI_STATUS_BAR_WIDTH, CLI_STATUS_VALUE_SIZE or CLI_STATUS_SHADOW_SIZE
+uint8_t cliSetStatusFields(const struct CliStatusField *fields, uint8_t count);
+
+// Set the minimum time between two status bar updates in ms
+void cliSetStatusBarInterval(uint16_t interval);
+
+// Reserve the status bar rows at the top of a terminal with terminalRows rows using a scroll region,
+// command output scrolls below the status bar, which is updated in place without counting line feeds
+// The scroll region is set while the status bar flag is set, terminalRows 0 prints the status bar above each prompt
+// Return value:    1: terminal rows set
+//                  0: terminalRows leaves no row below the status bar fields
+uint8_t cliSetStatusScrollRegion(uint8_t terminalRows);
+
+// Clear the screen, the status bar rows are kept in scroll region mode
+void cliClearScreen();
+
+// Start counting the lines printed to be overwritten by cliRewindOutput()
+void cliMarkOutput();
+
+// Move the cursor back to the first line printed since cliMarkOutput() and clear the screen below,
+// so the next output overwrites it in place. Lines are counted again from there
+void cliRewindOutput();
+
 // Update status bar in terminal
 void cliPrintStatusBar(unsigned char hideCursor);
 
@@ -223,7 +386,14 @@ void cliPrintRcvdString();
 // Print ring buffer
 void cliPrintRingBuffer();
 
-// Receive serial data dn store it in a ring buffer
+// Get the number of received characters lost due to a full receive ring buffer or an UART data overrun
+unsigned int cliGetRxOverruns();
+
+// Get the number of received characters discarded due to a framing or parity error
+unsigned int cliGetRxFrameErrors();
+
+// Receive serial data and store it in the ring buffer of the instance selected, the USART RX Complete ISRs
+// store into the ring buffer of the instance bound to their USART, safe to call with interrupts enabled
 void cliReceiveByte(char charRcvd);
 
 // Command line interface state machine to be used with a terminal programme
@@ -0,0 +1,82 @@
+/*
+ * File:            clock.h
+ * Author:          Thomas Jerman
+ * Date Created:    18.10.2026
+ * Version: 1.0:    DD.MM.YYYY
+ * Last Modified:   DD.MM.YYYY
+ *
+ * Description:
+ * Providing a monotonic clock based on the 125 us frames of Timer2 and the TCNT2
+ * fraction of the current frame: milliseconds, microseconds, a 64 bit uptime and
+ * timeout helpers. Reads are atomic and may be used in the main loop and in ISRs
+ *
+ * License:
+ * This code is released under Creative Commons Legal Code CC0 1.0 Universal
+ *
+ * Contact:
+ * jr@htl-kaindorf.at
+ */
+
+#ifndef CLOCK_H_INCLUDED
+#define CLOCK_H_INCLUDED
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/****************************************************/
+// GLOBAL DEFINES
+/****************************************************/
+
+#define CLOCK_FRAMES_PER_MS         8       // Timer2 frames of 125 us per millisecond
+#define CLOCK_US_PER_FRAME          125     // microseconds per Timer2 frame
+
+/****************************************************/
+// GLOBAL STRUCT DEFINITION
+/****************************************************/
+
+/****************************************************/
+// GLOBAL STRUCT VARIABLE DECLARATION, INIT
+/****************************************************/
+
+/****************************************************/
+// GLOBAL MACROS
+/****************************************************/
+
+/****************************************************/
+// GLOBAL FUNCTIONS
+/****************************************************/
+
+// Advance the clock by one frame, called by ISR(TIMER2_COMPA_vect) only
+void clockTick();
+
+// Get the milliseconds since timer2CTCInit(), wraps after 49.7 days
+uint32_t clockMillis();
+
+// Get the microseconds since timer2CTCInit() with a resolution of 1 us, wraps after 71.6 minutes
+uint32_t clockMicros();
+
+// Get the microseconds since timer2CTCInit() without wrapping
+uint64_t clockUptimeMicros();
+
+// Get the deadline timeout milliseconds from now, check it with clockExpiredMillis()
+uint32_t clockDeadlineMillis(uint32_t timeout);
+
+// Check a deadline of clockDeadlineMillis(), valid for timeouts up to 24.8 days
+// Return value:    1: deadline passed
+//                  0: deadline ahead
+uint8_t clockExpiredMillis(uint32_t deadline);
+
+// Get the deadline timeout microseconds from now, check it with clockExpiredMicros()
+uint32_t clockDeadlineMicros(uint32_t timeout);
+
+// Check a deadline of clockDeadlineMicros(), valid for timeouts up to 35.8 minutes
+// Return value:    1: deadline passed
+//                  0: deadline ahead
+uint8_t clockExpiredMicros(uint32_t deadline);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -28,10 +28,75 @@ extern "C" {
 
 //#define SHOW_TERMINAL_SHORTCUTS
 
+#define CMD_NAME_SIZE               6       // maximum command name length + 1
+#define CMD_DESCRIPTION_SIZE        32      // maximum description length + 1
+#define CMD_PARAMS_SIZE             24      // maximum parameter description length + 1
+#define CMD_KEYWORDS_SIZE           12      // maximum length of the space separated keywords + 1
+#define CMD_ARGS_MAX                3       // maximum number of parameters converted by the argument schema
+
+#define CMD_USER                    0       // command available for all users
+#define CMD_SUPERUSER               1       // command available for the superuser only
+
+#define CMD_SFR_VERBOSE             0       // print each SFR updated from EEPROM
+#define CMD_SFR_QUIET               1       // update SFRs from EEPROM without printing
+
+#define CMD_DONE                    0       // returned by a command step which has completed
+#define CMD_PENDING                 1       // returned by a command step to be called again
+
+// Argument types of the argument schema
+#define CMD_ARG_NONE                0x00    // no further parameter
+#define CMD_ARG_HEX                 0x01    // hexadecimal number up to max, optionally prefixed by 0x
+#define CMD_ARG_DEC                 0x02    // decimal number up to max
+#define CMD_ARG_WORD                0x03    // one of the keywords of the command
+#define CMD_ARG_TEXT                0x04    // any token, not converted
+#define CMD_ARG_TYPE_MASK           0x0F
+
+// Argument flags or'ed to the argument type
+#define CMD_ARG_KEYWORD             0x40    // one of the keywords of the command is accepted instead of a number
+#define CMD_ARG_OPTIONAL            0x80    // parameter may be missing, all following parameters have to be optional
+
+// Returned by cmdBindCommand()
+#define CMD_UNKNOWN                 0       // command unknown or requiring a higher privilege
+#define CMD_BOUND                   1       // handler found and parameters converted
+#define CMD_INVALID                 2       // parameters not matching the argument schema, reported already
+
 /****************************************************/
 // GLOBAL STRUCT DEFINITION
 /****************************************************/
 
+// Command handler, called with the login status of the current user
+typedef void (*CmdHandler)(uint8_t *login_status);
+
+// Resume point of a command step, set by the CMD_... macros
+struct CmdThread
+{
+    uint16_t line;                          // source line to continue at, 0 to start
+};
+
+// Step of a resumable command, called from the main loop until it returns CMD_DONE
+typedef uint8_t (*CmdStep)(struct CmdThread *thread, uint8_t *login_status);
+
+// Parameter of the argument schema, checked and converted before the command handler is called
+struct CmdArg
+{
+    uint8_t type;                           // CMD_ARG_... type or'ed with CMD_ARG_KEYWORD and CMD_ARG_OPTIONAL
+    uint16_t max;                           // largest number accepted by CMD_ARG_HEX and CMD_ARG_DEC
+};
+
+// Command table entry to be stored in program memory (PROGMEM)
+// Command tables have to be sorted by name in ascending strcmp order for binary search
+struct CmdEntry
+{
+    char name[CMD_NAME_SIZE];               // command name
+    CmdHandler handler;                     // function executing the command
+    uint8_t privilege;                      // CMD_USER or CMD_SUPERUSER
+    char shortcut;                          // CTRL-key executing the command (e.g. CTRL_A) or 0
+    char description[CMD_DESCRIPTION_SIZE]; // description printed by the help screens
+    char params[CMD_PARAMS_SIZE];           // parameters printed by the help screens
+    char keywords[CMD_KEYWORDS_SIZE];       // space separated keywords accepted by CMD_ARG_WORD and CMD_ARG_KEYWORD
+    struct CmdArg args[CMD_ARGS_MAX];       // argument schema of the parameters, terminated by CMD_ARG_NONE
+};
+
 /****************************************************/
 // GLOBAL STRUCT VARIABLE DECLARATION, INIT
 /****************************************************/
@@ -40,21 +105,81 @@ extern "C" {
 // GLOBAL MACROS
 /****************************************************/
 
+// Initializers of struct CmdArg, flags: 0, CMD_ARG_KEYWORD or CMD_ARG_OPTIONAL
+#define CMD_HEX(max, flags)                 {CMD_ARG_HEX | (flags), (max)}
+#define CMD_HEX8(flags)                     CMD_HEX(0xFF, flags)
+#define CMD_HEX16(flags)                    CMD_HEX(0xFFFF, flags)
+#define CMD_DEC(max, flags)                 {CMD_ARG_DEC | (flags), (max)}
+#define CMD_WORD(flags)                     {CMD_ARG_WORD | (flags), 0}
+#define CMD_TEXT(flags)                     {CMD_ARG_TEXT | (flags), 0}
+
+// Stackless coroutines for command steps: a step returns to the main loop while it waits and
+// continues behind the wait on its next call. Local variables are lost while waiting, keep them
+// in static variables. Waits must neither share a source line nor be placed within a switch
+#define CMD_BEGIN(thread)                   switch ((thread)->line) { case 0:
+#define CMD_WAIT_UNTIL(thread, condition)   do { (thread)->line = __LINE__; case __LINE__: \
+                                                 if (!(condition)) return CMD_PENDING; } while (0)
+#define CMD_YIELD(thread)                   do { (thread)->line = __LINE__; return CMD_PENDING; \
+                                                 case __LINE__:; } while (0)
+#define CMD_END(thread)                     } (thread)->line = 0; return CMD_DONE
+
 /****************************************************/
 // GLOBAL FUNCTIONS
 /****************************************************/
 
 // Executes all commands defined
+// A command line or CTRL-key received while a command is pending is handed over to the pending command
 uint8_t cmdExecuteCommand(uint8_t *login_status);
 
+// Continue the command executing in step, called by a command handler before it returns
+// step is called from the main loop by cmdService() until it returns CMD_DONE, on Ctrl+C cancel is called
+// instead, it may be NULL. Received characters are ignored while step waits unless it prints a prompt
+void cmdResume(CmdStep step, CmdHandler cancel);
+
+// Call the step of the pending command, call cyclically from the main loop
+// Return value:    1: pending command completed or cancelled, print the prompt
+//                  0: no command pending or the command is still pending
+uint8_t cmdService(uint8_t *login_status);
+
+// Cancel the pending command as on Ctrl+C without printing, e.g. requested by the binary protocol
+// Return value:    1: command cancelled
+//                  0: no command pending
+uint8_t cmdCancel(uint8_t *login_status);
+
+// Get if a command is pending, the prompt is printed once it completed
+uint8_t cmdIsPending();
+
+// Get if the pending command is called with a command line received, e.g. after printing a password prompt
+uint8_t cmdIsLineReceived();
+
+// Look up the command cliGetArgv(0) available with login_status, default commands are searched first,
+// and check and convert its parameters by the argument schema of the command
+// Return value:    CMD_BOUND: *handler set, converted parameters available by cmdGetArgValue() and cmdGetArgKeyword()
+//                  CMD_UNKNOWN: command unknown or requiring a higher privilege
+//                  CMD_INVALID: parameters not matching the argument schema, reported already
+uint8_t cmdBindCommand(uint8_t login_status, CmdHandler *handler);
+
+// Get the number converted from parameter index (1 = first parameter) by the argument schema
+// Return value: 0 if the parameter is missing, a keyword or not converted
+uint16_t cmdGetArgValue(uint8_t index);
+
+// Get the keyword given as parameter index (1 = first parameter)
+// Return value: position of the keyword in the keywords of the command (1 = first), 0 if no keyword was given
+uint8_t cmdGetArgKeyword(uint8_t index);
+
 // Shows the default commands
 void cmdShowDefaultCommands(uint8_t superuser_flag);
 
 // Shows the application commands
 void cmdShowApplicationCommands();
 
-// Sets a flag to store 0/1 information in EEPROM
-void cmdSetFlag(uint8_t *variable);
+// Register the application's command table stored in program memory (PROGMEM)
+// Return value:    1: command table registered
+//                  0: table not sorted by name, not registered
+uint8_t cmdSetApplicationCommands(const struct CmdEntry *table, uint8_t count);
+
+// Sets a configuration item (enum CfgItem) to store 0/1 information persistently
+void cmdSetFlag(uint8_t item);
 
 // Reads 8 Bit SFR
 uint8_t cmdRead8BitRegister(uint8_t address);
@@ -62,19 +187,24 @@ uint8_t cmdRead8BitRegister(uint8_t address);
 // Writes 8 Bit SFR
 void cmdWrite8BitRegister(uint8_t address, uint8_t byte);
 
-// Reads 16 Bit SFR
+// Reads 16 Bit SFR, low byte first with interrupts masked
 uint16_t cmdRead16BitRegister(uint8_t address);
 
-// Writes 16 Bit SFR
+// Writes 16 Bit SFR, high byte first with interrupts masked
 void cmdWrite16BitRegister(uint8_t address, uint16_t value);
 
-// Updates special function register at "address" from EEPROM
-uint8_t cmdUpdateSfrFromEEPROM(uint8_t address);
+// Updates special function register at "address" from EEPROM using its persisted width
+// quiet: CMD_SFR_VERBOSE or CMD_SFR_QUIET
+// Return value: current value of the register
+uint16_t cmdUpdateSfrFromEEPROM(uint8_t address, uint8_t quiet);
 
-// Updates all special function registers from EEPROM
-void cmdUpdateAllSfrFromEEPROM();
+// Updates all special function registers persisted in EEPROM
+// quiet: CMD_SFR_VERBOSE or CMD_SFR_QUIET
+// Return value: number of registers updated
+uint8_t cmdUpdateAllSfrFromEEPROM(uint8_t quiet);
 
 // Switches user from standard to superuser or vice versa
+// The password is read by a pending command, call from a command handler only
 void cmdSwitchUser(uint8_t *login_status, uint8_t echoAllCommandsFlag);
 
 #ifdef __cplusplus
@@ -0,0 +1,95 @@
+/*
+ * File:            config.h
+ * Author:          Thomas Jerman
+ * Date Created:    18.10.2026
+ * Version: 1.0:    DD.MM.YYYY
+ * Last Modified:   DD.MM.YYYY
+ *
+ * Description:
+ * Providing persistent configuration items mirrored in RAM
+ *
+ * License:
+ * This code is released under Creative Commons Legal Code CC0 1.0 Universal
+ *
+ * Contact:
+ * jr@htl-kaindorf.at
+ */
+
+#ifndef CONFIG_H_INCLUDED
+#define CONFIG_H_INCLUDED
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/****************************************************/
+// GLOBAL DEFINES
+/****************************************************/
+
+// Increase CFG_VERSION whenever the meaning of stored items changes,
+// the configuration is reset to its defaults on the next boot then
+#define CFG_VERSION                 1
+
+// Configuration items, add new items above CFG_ITEMS_COUNT and
+// set their default value in cfgDefaults[] in config.c
+enum CfgItem
+{
+    CFG_ECHO_ALL_COMMANDS = 0,
+    CFG_COMMAND_HISTORY,
+    CFG_COMMAND_DETAILS,
+    CFG_STATUS_BAR,
+    CFG_STATUS_ROWS,
+    CFG_ITEMS_COUNT
+};
+
+/****************************************************/
+// GLOBAL STRUCT DEFINITION
+/****************************************************/
+
+/****************************************************/
+// GLOBAL STRUCT VARIABLE DECLARATION, INIT
+/****************************************************/
+
+/****************************************************/
+// GLOBAL MACROS
+/****************************************************/
+
+/****************************************************/
+// GLOBAL FUNCTIONS
+/****************************************************/
+
+// Import the flags and persisted SFR values of the EEPROM layout used before the journal, call once before
+// journalInit() at startup. Nothing is done if the journal has been formatted, values not fitting into it are dropped
+// Return value: number of values imported
+uint8_t cfgMigrate();
+
+// Load the configuration from the journal into RAM, call journalInit() before
+// Defaults are used for items never written and if the stored version does not match
+// Return value:    1: configuration loaded from the journal
+//                  0: stored version did not match, defaults loaded
+uint8_t cfgInit();
+
+// Get the value of a configuration item, 0 for invalid items
+uint8_t cfgGet(uint8_t item);
+
+// Set the value of a configuration item in RAM, it is handed over to the journal by cfgService()
+// Return value:    1: value set
+//                  0: value set in RAM only, the journal has no entry left for the item, cfgService() retries
+uint8_t cfgSet(uint8_t item, uint8_t value);
+
+// Hand over changed configuration items to the journal as long as the EEPROM write queue has free entries
+// Items not fitting into a full journal stay changed and are handed over once entries have been erased
+// Call cyclically from the main loop, never blocks unless the journal has to be compacted
+// Return value:    1: all changed items handed over or kept for a full journal
+//                  0: EEPROM write queue full, call again
+uint8_t cfgService();
+
+// Write back all changed configuration items to EEPROM, waits until all writes have completed
+// Return value: number of changed items not saved as the journal is full or the EEPROM is being cleared
+uint8_t cfgSave();
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
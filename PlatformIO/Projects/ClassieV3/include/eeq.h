@@ -0,0 +1,100 @@
+/*
+ * File:            eeq.h
+ * Author:          Thomas Jerman
+ * Date Created:    18.10.2026
+ * Version: 1.0:    DD.MM.YYYY
+ * Last Modified:   DD.MM.YYYY
+ *
+ * Description:
+ * Providing an EEPROM write queue drained by ISR(EE_READY_vect)
+ *
+ * License:
+ * This code is released under Creative Commons Legal Code CC0 1.0 Universal
+ *
+ * Contact:
+ * jr@htl-kaindorf.at
+ */
+
+#ifndef EEQ_H_INCLUDED
+#define EEQ_H_INCLUDED
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/****************************************************/
+// GLOBAL DEFINES
+/****************************************************/
+
+#define EEQ_SIZE                    16      // number of queue entries, power of two up to 128
+#define EEQ_SKIPS_PER_ISR           8       // maximum unchanged bytes skipped within one ISR call
+
+/****************************************************/
+// GLOBAL STRUCT DEFINITION
+/****************************************************/
+
+/****************************************************/
+// GLOBAL STRUCT VARIABLE DECLARATION, INIT
+/****************************************************/
+
+/****************************************************/
+// GLOBAL MACROS
+/****************************************************/
+
+/****************************************************/
+// GLOBAL FUNCTIONS
+/****************************************************/
+
+// Queue a byte to be written to EEPROM, bytes already holding the value are skipped
+// Return value:    1: byte queued
+//                  0: queue full, nothing queued
+uint8_t eeqWriteByte(uint16_t address, uint8_t value);
+
+// Queue a word to be written to EEPROM (low byte first), both bytes or none are queued
+// Return value:    1: word queued
+//                  0: queue full, nothing queued
+uint8_t eeqWriteWord(uint16_t address, uint16_t value);
+
+// Queue count bytes of src to be written to EEPROM starting at address, all bytes or none are queued
+// Each byte takes one queue entry, count must not exceed EEQ_SIZE
+// Return value:    1: bytes queued
+//                  0: queue full, nothing queued
+uint8_t eeqWriteBlock(uint16_t address, const void *src, uint8_t count);
+
+// Queue count bytes starting at address to be filled with value, e.g. 0xFF to clear the EEPROM
+// Return value:    1: range queued
+//                  0: queue full, nothing queued
+uint8_t eeqFill(uint16_t address, uint16_t count, uint8_t value);
+
+// Read a byte from EEPROM, the value of a pending write is returned if address is queued
+// Never starts a read while the ISR writes to EEPROM
+uint8_t eeqReadByte(uint16_t address);
+
+// Read a word from EEPROM (low byte first) using eeqReadByte()
+uint16_t eeqReadWord(uint16_t address);
+
+// Read count bytes from EEPROM into dst using eeqReadByte()
+void eeqReadBlock(void *dst, uint16_t address, uint16_t count);
+
+// Get the number of bytes still to be processed by the queue
+uint16_t eeqGetPending();
+
+// Get the number of bytes written (not skipped) since startup
+uint16_t eeqGetWritten();
+
+// Return value:    1: queue empty and no EEPROM write in progress
+//                  0: queue busy, EVENT_EEPROM is posted once it runs empty
+uint8_t eeqIsIdle();
+
+// Set a function called from ISR(EE_READY_vect) each time the queue runs empty, NULL to disable
+// Keep it short, it is executed in interrupt context
+void eeqSetDoneCallback(void (*doneCallback)(void));
+
+// Wait until all queued bytes have been written to EEPROM
+void eeqFlush();
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,91 @@
+/*
+ * File:            event.h
+ * Author:          Thomas Jerman
+ * Date Created:    18.10.2026
+ * Version: 1.0:    DD.MM.YYYY
+ * Last Modified:   DD.MM.YYYY
+ *
+ * Description:
+ * Providing a lock-free single-producer/single-consumer event queue: ISRs post typed,
+ * time stamped events, the main loop takes them with eventGet() or eventWait().
+ * All ISRs together form the single producer as they do not nest, the main loop
+ * posts within ATOMIC_BLOCK(ATOMIC_RESTORESTATE). Events lost on a full queue are
+ * reported as one EVENT_OVERFLOW, the main loop then polls all event sources
+ *
+ * License:
+ * This code is released under Creative Commons Legal Code CC0 1.0 Universal
+ *
+ * Contact:
+ * jr@htl-kaindorf.at
+ */
+
+#ifndef EVENT_H_INCLUDED
+#define EVENT_H_INCLUDED
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/****************************************************/
+// GLOBAL DEFINES
+/****************************************************/
+
+#define EVENT_QUEUE_SIZE            16      // number of queued events, power of two up to 128
+
+// Event types
+#define EVENT_OVERFLOW              0x00    // events lost, poll all event sources
+#define EVENT_CLI_RX                0x01    // character received by ISR(USART_RX_vect), data: character
+#define EVENT_CAPTURE               0x02    // edge captured by ISR(TIMER1_CAPT_vect), data: capture index
+#define EVENT_SCHED                 0x03    // soft task flagged by the scheduler, data: task number
+#define EVENT_SECOND                0x04    // second elapsed, data: low byte of the seconds
+#define EVENT_EEPROM                0x05    // EEPROM write queue drained by ISR(EE_READY_vect), data: 0
+#define EVENT_USER                  0x80    // first event type available for the application
+
+/****************************************************/
+// GLOBAL STRUCT DEFINITION
+/****************************************************/
+
+struct Event
+{
+    uint8_t type;                       // EVENT_CLI_RX, EVENT_CAPTURE, ...
+    uint8_t data;                       // event specific data
+    uint16_t time;                      // low 16 bits of clockMillis() when posted
+};
+
+/****************************************************/
+// GLOBAL STRUCT VARIABLE DECLARATION, INIT
+/****************************************************/
+
+/****************************************************/
+// GLOBAL MACROS
+/****************************************************/
+
+/****************************************************/
+// GLOBAL FUNCTIONS
+/****************************************************/
+
+// Post an event, call within an ISR or with interrupts disabled
+// Return value:    1: event posted
+//                  0: queue full, event lost and reported as EVENT_OVERFLOW
+uint8_t eventPost(uint8_t type, uint8_t data);
+
+// Take the next event, EVENT_OVERFLOW first if events were lost
+// Return value:    1: event copied to event
+//                  0: no event
+uint8_t eventGet(struct Event *event);
+
+// Wait for the next event, the CPU sleeps in SLEEP_MODE_IDLE while the queue is empty
+// Call with interrupts enabled from the main loop only
+void eventWait(struct Event *event);
+
+// Get the number of events waiting in the queue
+uint8_t eventGetPending();
+
+// Get the number of events lost since startup
+uint16_t eventGetDropped();
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,85 @@
+/*
+ * File:            hal.h
+ * Author:          Thomas Jerman
+ * Date Created:    18.10.2026
+ * Version: 1.0:    DD.MM.YYYY
+ * Last Modified:   DD.MM.YYYY
+ *
+ * Description:
+ * Providing the hardware abstraction used by the Classie modules. Registers are
+ * accessed by their avr-libc names, which the native build maps to a simulated
+ * register file (see sim/include), this header covers everything else
+ *
+ * License:
+ * This code is released under Creative Commons Legal Code CC0 1.0 Universal
+ *
+ * Contact:
+ * jr@htl-kaindorf.at
+ */
+
+#ifndef HAL_H_INCLUDED
+#define HAL_H_INCLUDED
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/****************************************************/
+// GLOBAL DEFINES
+/****************************************************/
+
+/****************************************************/
+// GLOBAL STRUCT DEFINITION
+/****************************************************/
+
+/****************************************************/
+// GLOBAL STRUCT VARIABLE DECLARATION, INIT
+/****************************************************/
+
+#ifndef CLASSIE_NATIVE
+extern FILE halStdout;                  // the single stream stdout is connected to, see hal.c
+#endif
+
+/****************************************************/
+// GLOBAL MACROS
+/****************************************************/
+
+#ifdef CLASSIE_NATIVE
+
+#include "sim.h"
+
+// Pointer to the 8 bit special function register at address
+#define HAL_SFR8(address)           (&simIo[(uint8_t) (address)])
+
+// Connect stdout to the character output function putChar
+#define HAL_STDOUT_INIT(putChar)    simStdoutInit(putChar)
+
+// Called in loops waiting for an ISR, runs the pending simulated interrupts
+#define HAL_BUSY_WAIT()             simService()
+
+#else
+
+// Pointer to the 8 bit special function register at address
+#define HAL_SFR8(address)           ((volatile uint8_t *) (uintptr_t) (address))
+
+// Connect stdout to the character output function putChar, all call sites share halStdout
+#define HAL_STDOUT_INIT(putChar)                                                        \
+{                                                                                       \
+    fdev_setup_stream(&halStdout, putChar, NULL, _FDEV_SETUP_WRITE);                    \
+    stdout = &halStdout;                                                                \
+}
+
+// Called in loops waiting for an ISR, nothing to do on the target
+#define HAL_BUSY_WAIT()
+
+#endif
+
+/****************************************************/
+// GLOBAL FUNCTIONS
+/****************************************************/
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,65 @@
+/*
+ * File:            history.h
+ * Author:          Thomas Jerman
+ * Date Created:    18.10.2026
+ * Version: 1.0:    DD.MM.YYYY
+ * Last Modified:   DD.MM.YYYY
+ *
+ * Description:
+ * Providing persistence of the newest HIST_PERSIST_COUNT commands of the CLI history in the
+ * EEPROM area reserved behind the journal banks. Each save rewrites the same EEPROM cells, so saving
+ * is optional (HIST_PERSIST_COUNT 0 by default) and done by histSave() on reset (rst) only
+ *
+ * License:
+ * This code is released under Creative Commons Legal Code CC0 1.0 Universal
+ *
+ * Contact:
+ * jr@htl-kaindorf.at
+ */
+
+#ifndef HISTORY_H_INCLUDED
+#define HISTORY_H_INCLUDED
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/****************************************************/
+// GLOBAL DEFINES
+/****************************************************/
+
+#ifndef HIST_PERSIST_COUNT
+#define HIST_PERSIST_COUNT          0       // newest commands saved to EEPROM, e.g. -DHIST_PERSIST_COUNT=4, 0 disables saving
+#endif
+#define HIST_EEPROM_ADDRESS         (E2END + 1 - JOURNAL_RESERVED)  // first byte of the history area
+#define HIST_EEPROM_SIZE            JOURNAL_RESERVED                // bytes of the history area
+
+/****************************************************/
+// GLOBAL STRUCT DEFINITION
+/****************************************************/
+
+/****************************************************/
+// GLOBAL STRUCT VARIABLE DECLARATION, INIT
+/****************************************************/
+
+/****************************************************/
+// GLOBAL MACROS
+/****************************************************/
+
+/****************************************************/
+// GLOBAL FUNCTIONS
+/****************************************************/
+
+// Load the saved commands into the history of the console, CLI instance 0, call cliInit() before
+// Return value: number of commands loaded, 0 if none were saved or the history area is corrupted
+uint8_t histLoad();
+
+// Write back the newest commands of the console, CLI instance 0, to EEPROM if its history changed since it was
+// loaded or saved, waits until all writes have completed. Nothing is saved while the EEPROM is cleared
+void histSave();
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,62 @@
+/*
+ * File:            idle.h
+ * Author:          Thomas Jerman
+ * Date Created:    18.10.2026
+ * Version: 1.0:    DD.MM.YYYY
+ * Last Modified:   DD.MM.YYYY
+ *
+ * Description:
+ * Providing idle sleep of the main loop in SLEEP_MODE_IDLE and the CPU load measured
+ * as the time not spent sleeping within a window of IDLE_WINDOW_US microseconds.
+ * ISR(TIMER2_COMPA_vect) waking the CPU is counted as busy time, other ISRs waking
+ * the CPU are counted as idle time
+ *
+ * License:
+ * This code is released under Creative Commons Legal Code CC0 1.0 Universal
+ *
+ * Contact:
+ * jr@htl-kaindorf.at
+ */
+
+#ifndef IDLE_H_INCLUDED
+#define IDLE_H_INCLUDED
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/****************************************************/
+// GLOBAL DEFINES
+/****************************************************/
+
+#define IDLE_WINDOW_US              1000000UL   // CPU load measurement window in microseconds
+
+/****************************************************/
+// GLOBAL STRUCT DEFINITION
+/****************************************************/
+
+/****************************************************/
+// GLOBAL STRUCT VARIABLE DECLARATION, INIT
+/****************************************************/
+
+/****************************************************/
+// GLOBAL MACROS
+/****************************************************/
+
+/****************************************************/
+// GLOBAL FUNCTIONS
+/****************************************************/
+
+// Sleep in SLEEP_MODE_IDLE until the next interrupt if isIdle() returns 1
+// isIdle() is called with interrupts disabled and checks that no module has pending work
+// Call with interrupts enabled from the main loop only
+void idleSleep(uint8_t (*isIdle)());
+
+// Get the CPU load in percent of the last completed measurement window
+uint8_t idleGetLoad();
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
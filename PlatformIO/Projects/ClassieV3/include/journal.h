@@ -0,0 +1,116 @@
+/*
+ * File:            journal.h
+ * Author:          Thomas Jerman
+ * Date Created:    18.10.2026
+ * Version: 1.0:    DD.MM.YYYY
+ * Last Modified:   DD.MM.YYYY
+ *
+ * Description:
+ * Providing a wear-leveled key/value journal in EEPROM with a RAM index
+ *
+ * License:
+ * This code is released under Creative Commons Legal Code CC0 1.0 Universal
+ *
+ * Contact:
+ * jr@htl-kaindorf.at
+ */
+
+#ifndef JOURNAL_H_INCLUDED
+#define JOURNAL_H_INCLUDED
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/****************************************************/
+// GLOBAL DEFINES
+/****************************************************/
+
+// The EEPROM is split into two banks, records are appended to the active bank. If it is full,
+// all live entries are copied to the other bank, which becomes active with the next generation
+// The last JOURNAL_RESERVED bytes of the EEPROM are left to the command history, see history.h
+#define JOURNAL_RESERVED            128
+#define JOURNAL_BANK_SIZE           ((E2END + 1 - JOURNAL_RESERVED) / 2)
+#define JOURNAL_ENTRIES_MAX         24      // maximum number of live entries held in the RAM index
+
+// Record types: the upper nibble selects the name space of the key
+#define JOURNAL_TYPE_MASK           0xF0
+#define JOURNAL_TYPE_SETTING        0x10    // key = configuration item, see config.h
+#define JOURNAL_TYPE_SFR            0x20    // key = address of an 8 bit special function register
+#define JOURNAL_TYPE_SFR16          0x21    // key = address of a 16 bit special function register
+
+// Return values of journalWrite()
+#define JOURNAL_OK                  0       // value stored or queued to be written to EEPROM
+#define JOURNAL_BUSY                1       // EEPROM write queue full or EEPROM being cleared, try again
+#define JOURNAL_FULL                2       // RAM index full, key not stored
+
+/****************************************************/
+// GLOBAL STRUCT DEFINITION
+/****************************************************/
+
+// Live entry of the RAM index
+struct JournalEntry
+{
+    uint8_t type;                       // JOURNAL_TYPE_...
+    uint8_t key;                        // key within the name space of type
+    uint16_t value;                     // latest value written
+};
+
+/****************************************************/
+// GLOBAL STRUCT VARIABLE DECLARATION, INIT
+/****************************************************/
+
+/****************************************************/
+// GLOBAL MACROS
+/****************************************************/
+
+/****************************************************/
+// GLOBAL FUNCTIONS
+/****************************************************/
+
+// Build the RAM index by one sequential scan of the active bank
+// A bank is formatted if none holds a valid header, e.g. after clearing the EEPROM
+// Return value: number of live entries
+uint8_t journalInit();
+
+// Check whether the EEPROM holds a journal, e.g. to import the layout of an older firmware before journalInit()
+// Return value:    1: a bank holds a valid header
+//                  0: no bank formatted
+uint8_t journalIsFormatted();
+
+// Find the live entry of key within the name space of type
+// Return value: NULL if key has never been written
+const struct JournalEntry *journalFind(uint8_t type, uint8_t key);
+
+// Append a record to the journal unless the entry already holds value
+// Compacts the journal into the other bank if the active bank is full, waiting for free queue entries then
+// Return value: JOURNAL_OK, JOURNAL_BUSY or JOURNAL_FULL
+uint8_t journalWrite(uint8_t type, uint8_t key, uint16_t value);
+
+// Remove all entries within the name space of type and compact the journal
+void journalErase(uint8_t type);
+
+// Suspend writing to EEPROM while it is cleared, journalWrite() returns JOURNAL_BUSY until journalInit()
+void journalSuspend();
+
+// Return value:    1: writing suspended by journalSuspend() until journalInit()
+//                  0: records are written
+uint8_t journalIsSuspended();
+
+// Get the number of live entries
+uint8_t journalGetCount();
+
+// Get a live entry by index in the range [0, journalGetCount() - 1]
+const struct JournalEntry *journalGetEntry(uint8_t index);
+
+// Get the number of records which can be appended until the journal is compacted
+uint16_t journalGetFree();
+
+// Get the generation of the active bank, incremented on each compaction
+uint8_t journalGetGeneration();
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -49,6 +49,10 @@ extern "C" {
 // using timer1StartInputCapture
 void necStartReceiving();
 
+// Stop receiving pulses, e.g. to capture other signals at ICP1 (PB0) until necStartReceiving() is called
+// Return value: capture array of NEC_CAPTURE_ARRAY_SIZE entries, unused while receiving is stopped
+volatile uint32_t *necStopReceiving();
+
 // Process received NEC pulses until the number of bytes
 // defined in NEC_DATA_ARRAY_SIZE has been reveived
 int8_t necProcessRxData();
@@ -0,0 +1,86 @@
+/*
+ * File:            out.h
+ * Author:          Thomas Jerman
+ * Date Created:    18.10.2026
+ * Version: 1.0:    DD.MM.YYYY
+ * Last Modified:   DD.MM.YYYY
+ *
+ * Description:
+ * Providing lean formatted output without vfprintf: padded decimal, fixed-point decimal and
+ * hexadecimal numbers formatted into a buffer or written straight into the UART transmit ring buffer
+ * by cliWrite(), and strings in program memory. Fixed-point numbers replace %f, so the float printf
+ * library (-Wl,-u,vfprintf -lprintf_flt) is not linked unless OUT_PRINTF_FLT is defined
+ *
+ * License:
+ * This code is released under Creative Commons Legal Code CC0 1.0 Universal
+ *
+ * Contact:
+ * jr@htl-kaindorf.at
+ */
+
+#ifndef OUT_H_INCLUDED
+#define OUT_H_INCLUDED
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/****************************************************/
+// GLOBAL DEFINES
+/****************************************************/
+
+//#define OUT_PRINTF_FLT                    // format with printf_P("%f") instead, link the float printf library
+
+#define OUT_NUMBER_SIZE             12      // buffer size of any number formatted without padding, '\0' included
+#define OUT_WIDTH_MAX               16      // widest padded number written by outUnsigned() and outFixed()
+#define OUT_DECIMALS_MAX            9       // most fraction digits of a fixed-point number fitting OUT_NUMBER_SIZE
+
+/****************************************************/
+// GLOBAL STRUCT DEFINITION
+/****************************************************/
+
+/****************************************************/
+// GLOBAL STRUCT VARIABLE DECLARATION, INIT
+/****************************************************/
+
+/****************************************************/
+// GLOBAL MACROS
+/****************************************************/
+
+/****************************************************/
+// GLOBAL FUNCTIONS
+/****************************************************/
+
+// Format value right-aligned to width characters filled with pad (' ' or '0') into buffer, '\0' terminated
+// buffer has to hold width + 1 or OUT_NUMBER_SIZE bytes, whichever is larger
+// Return value: number of characters formatted
+uint8_t outFormatUnsigned(char *buffer, uint32_t value, uint8_t width, char pad);
+
+// Format value scaled by 10^decimals as fixed-point number right-aligned to width characters into buffer,
+// e.g. value 1234 with 1 decimal as "123.4", buffer size as of outFormatUnsigned(), fraction digits beyond
+// OUT_DECIMALS_MAX are cut off
+// Return value: number of characters formatted
+uint8_t outFormatFixed(char *buffer, uint32_t value, uint8_t decimals, uint8_t width);
+
+// Format value as digits upper case hexadecimal digits with leading zeros into buffer, '\0' terminated
+// Return value: number of characters formatted
+uint8_t outFormatHex(char *buffer, uint16_t value, uint8_t digits);
+
+// Write value right-aligned to width characters filled with spaces, like printf("%*lu")
+void outUnsigned(uint32_t value, uint8_t width);
+
+// Write value scaled by 10^decimals as fixed-point number right-aligned to width characters, like printf("%*.*f")
+// with at most OUT_DECIMALS_MAX fraction digits
+void outFixed(uint32_t value, uint8_t decimals, uint8_t width);
+
+// Write value as digits upper case hexadecimal digits with leading zeros, like printf("%0*X")
+void outHex(uint16_t value, uint8_t digits);
+
+// Write the '\0' terminated string stored in program memory, e.g. outString_P(PSTR("text"))
+void outString_P(const char *string);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
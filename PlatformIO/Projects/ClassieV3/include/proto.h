@@ -0,0 +1,89 @@
+/*
+ * File:            proto.h
+ * Author:          Thomas Jerman
+ * Date Created:    18.10.2026
+ * Version: 1.0:    DD.MM.YYYY
+ * Last Modified:   DD.MM.YYYY
+ *
+ * Description:
+ * Providing a binary request/response protocol for machine clients on the UART of a CLI instance,
+ * entered by receiving CLI_BINARY_MAGIC at the prompt. Frames are COBS encoded and ended by a zero byte,
+ * the switch is acknowledged by a single zero byte. Decoded frames:
+ *
+ * Request:  SEQ ID TYPE [command line] CRC16
+ * Response: SEQ ID TYPE|PROTO_RESPONSE STATUS [result] CRC16
+ *
+ * SEQ counts the frames of each direction, a request repeated with the SEQ and ID of the last command
+ * answered gets the same response again without executing the command twice. ID is copied from the
+ * request into its response, so requests can be pipelined. CRC16 is the CRC-16/XMODEM of all preceding
+ * bytes, high byte first. Frames with a wrong CRC or length are dropped without response.
+ * Command lines are bound to the same handlers as typed ones, their text output is dropped and the
+ * raw values handed over by protoPutResult() are returned instead. The response of a resumable command
+ * follows once it completed, further command requests are answered with PROTO_BUSY meanwhile
+ *
+ * License:
+ * This code is released under Creative Commons Legal Code CC0 1.0 Universal
+ *
+ * Contact:
+ * jr@htl-kaindorf.at
+ */
+
+#ifndef PROTO_H_INCLUDED
+#define PROTO_H_INCLUDED
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/****************************************************/
+// GLOBAL DEFINES
+/****************************************************/
+
+#define PROTO_RESULT_MAX            32      // result bytes of a response, further results are dropped
+
+// Request types, the response type has PROTO_RESPONSE set in addition
+#define PROTO_COMMAND               0x01    // execute the command line following the type
+#define PROTO_CANCEL                0x02    // cancel the pending command like Ctrl+C
+#define PROTO_EXIT                  0x03    // switch back to the command line, the prompt is printed
+#define PROTO_RESPONSE              0x80
+
+// Response status
+#define PROTO_OK                    0x00    // request executed, the result follows
+#define PROTO_UNKNOWN               0x01    // unknown command or missing privilege
+#define PROTO_INVALID               0x02    // parameters not matching the argument schema of the command
+#define PROTO_OVERFLOW              0x03    // command executed, result cut to PROTO_RESULT_MAX bytes
+#define PROTO_BUSY                  0x04    // command not executed while another command is pending
+#define PROTO_CANCELLED             0x05    // pending command cancelled, the result collected so far follows
+#define PROTO_BAD_TYPE              0x06    // unknown request type
+
+/****************************************************/
+// GLOBAL STRUCT DEFINITION
+/****************************************************/
+
+/****************************************************/
+// GLOBAL STRUCT VARIABLE DECLARATION, INIT
+/****************************************************/
+
+/****************************************************/
+// GLOBAL MACROS
+/****************************************************/
+
+/****************************************************/
+// GLOBAL FUNCTIONS
+/****************************************************/
+
+// Decode the requests received in binary mode of the CLI instance selected and send the responses,
+// call cyclically from the main loop
+// Return value:    1: switched back to the command line, print the prompt
+//                  0: binary mode continues or is not entered
+uint8_t protoService(uint8_t *login_status);
+
+// Append length bytes to the result of the command executed by a request, called by command handlers,
+// nothing is done for commands typed at the command line
+void protoPutResult(const void *data, uint8_t length);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
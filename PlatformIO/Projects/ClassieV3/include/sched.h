@@ -0,0 +1,91 @@
+/*
+ * File:            sched.h
+ * Author:          Thomas Jerman
+ * Date Created:    18.10.2026
+ * Version: 1.0:    DD.MM.YYYY
+ * Last Modified:   DD.MM.YYYY
+ *
+ * Description:
+ * Providing a cooperative task scheduler on top of the 125 us frames of Timer2.
+ * Hard tasks run within ISR(TIMER2_COMPA_vect), soft tasks are flagged by the ISR
+ * and run by schedService() in the main loop. A hard task exceeding the frame budget
+ * is counted as overrun and moved to the main loop after SCHED_OVERRUN_LIMIT
+ * overruns in a row. A hard run handed over to the main loop for lack of frame time
+ * wins: the ISR skips the task, counting an overrun, until schedService() completed it
+ *
+ * License:
+ * This code is released under Creative Commons Legal Code CC0 1.0 Universal
+ *
+ * Contact:
+ * jr@htl-kaindorf.at
+ */
+
+#ifndef SCHED_H_INCLUDED
+#define SCHED_H_INCLUDED
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/****************************************************/
+// GLOBAL DEFINES
+/****************************************************/
+
+#define SCHED_TASKS_MAX             8       // maximum number of registered tasks
+#define SCHED_FRAMES_PER_MS         8       // Timer2 frames of 125 us per millisecond
+#define SCHED_FRAME_BUDGET          200     // Timer2 counts (0.5 us) of a frame available for hard tasks
+#define SCHED_OVERRUN_LIMIT         3       // overruns in a row demoting a hard task to a soft task
+#define SCHED_INVALID_TASK          0xFF    // returned by schedAddTask() if no task was added
+
+// Task flags
+#define SCHED_HARD                  0x00    // run within ISR(TIMER2_COMPA_vect)
+#define SCHED_SOFT                  0x01    // run by schedService() in the main loop
+#define SCHED_DEMOTED               0x02    // hard task moved to the main loop after overruns
+
+/****************************************************/
+// GLOBAL STRUCT DEFINITION
+/****************************************************/
+
+/****************************************************/
+// GLOBAL STRUCT VARIABLE DECLARATION, INIT
+/****************************************************/
+
+/****************************************************/
+// GLOBAL MACROS
+/****************************************************/
+
+/****************************************************/
+// GLOBAL FUNCTIONS
+/****************************************************/
+
+// Register function to be run every period frames, the first time in frame phase (0 = next frame)
+// flags: SCHED_HARD or SCHED_SOFT
+// Return value: task number, SCHED_INVALID_TASK if all tasks are used or period is 0
+uint8_t schedAddTask(void (*function)(), uint16_t period, uint16_t phase, uint8_t flags);
+
+// Run all soft tasks flagged by ISR(TIMER2_COMPA_vect), call in the main loop
+void schedService();
+
+// Change the period of task, the next run is in frame phase (0 = next frame), period 0 suspends task
+// Return value:    1: period changed
+//                  0: invalid task
+uint8_t schedSetPeriod(uint8_t task, uint16_t period, uint16_t phase);
+
+// Get the number of registered tasks
+uint8_t schedGetTaskCount();
+
+// Get the flags of task, 0 for an invalid task
+uint8_t schedGetFlags(uint8_t task);
+
+// Get the overruns of task: a hard task exceeding the frame budget or due again before schedService() completed
+// the run handed over, a soft task flagged again before schedService() ran it, 0 for an invalid task
+uint16_t schedGetOverruns(uint8_t task);
+
+// Get the number of frames whose ISR was still running at the next compare match
+uint16_t schedGetFrameOverruns();
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
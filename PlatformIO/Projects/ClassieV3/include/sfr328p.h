@@ -28,8 +28,7 @@ extern "C" {
 
 /* Registers and associated bit numbers */
 
-#define SFR_IN_EEPROM_OFFSET                0x300
-#define EEPROM_ADDRESS_LIMIT                0x3FF
+#define EEPROM_ADDRESS_LIMIT                E2END   // last EEPROM address, 0x3FF on the ATmega328P
 
 #define PINB_ADDR       ((volatile uint8_t*) 0x23)
 #define PINB_ADDR       ((volatile uint8_t*) 0x23)
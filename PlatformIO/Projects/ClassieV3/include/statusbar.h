@@ -6,7 +6,7 @@
  * Last Modified:   DD.MM.2024
  *
  * Description:
- * Providing a function to set up a status bar
+ * Providing the status bar fields of the application
  *
  * License:
  * This code is released under Creative Commons Legal Code CC0 1.0 Universal
@@ -42,8 +42,8 @@ extern "C" {
 // GLOBAL FUNCTIONS
 /****************************************************/
 
-// Status bar setup
-void statusBar();
+// Register the status bar fields, only changed values are redrawn
+void statusBarRegister();
 
 #ifdef __cplusplus
 }
@@ -27,11 +27,24 @@ extern "C" {
 /****************************************************/
 
 #define MAX_TIC_TOCS_AVAILABLE  8
+#define TIMER2_HISTOGRAM_BINS   9       // log2 bins of 0.5 us counts: [0, 2), [2, 4), ... [128, 256), 256 and beyond
 
 /****************************************************/
 // GLOBAL STRUCT DEFINITION
 /****************************************************/
 
+// Execution time statistics of a tic toc slot, durations in counts of 0.5 us
+struct Timer2SlotStats
+{
+    uint16_t last;                                  // last duration
+    uint16_t min;                                   // shortest duration, 0xFFFF without samples
+    uint16_t max;                                   // worst-case duration
+    uint32_t sum;                                   // sum of all durations, mean = sum / count
+    uint32_t count;                                 // number of durations
+    uint16_t misses;                                // deadline misses: next frame started before timer2Toc()
+    uint16_t histogram[TIMER2_HISTOGRAM_BINS];      // durations per log2 bin, counts stop at 0xFFFF
+};
+
 /****************************************************/
 // GLOBAL STRUCT VARIABLE DECLARATION, INIT
 /****************************************************/
@@ -50,13 +63,22 @@ int timer2CTCInit();
 // Save TCNT of timer2 as start time
 void timer2Tic(uint8_t number);
 
-// Save TCNT of timer2 as stop time
+// Save TCNT of timer2 as stop time and add the duration since timer2Tic() to the statistics of number
+// Called within ISR(TIMER2_COMPA_vect): a compare match in between is counted as deadline miss
 void timer2Toc(uint8_t number);
 
 // Get tic toc durations for available tasks
 // In case of an invalid task: return value = 0
 unsigned long timer2GetTicTocTime(uint8_t task);
 
+// Copy the statistics of slot to stats, durations are given in counts of 0.5 us
+// Return value:    1: stats copied
+//                  0: invalid slot
+uint8_t timer2GetSlotStats(uint8_t slot, struct Timer2SlotStats *stats);
+
+// Reset the statistics of all slots
+void timer2ResetSlotStats();
+
 // Return pointer to seconds count
 unsigned long timer2GetSeconds();
 
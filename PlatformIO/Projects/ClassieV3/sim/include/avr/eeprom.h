@@ -0,0 +1,55 @@
+/*
+ * File:            eeprom.h
+ * Author:          Thomas Jerman
+ * Date Created:    18.10.2026
+ * Version: 1.0:    DD.MM.YYYY
+ * Last Modified:   DD.MM.YYYY
+ *
+ * Description:
+ * Native stand-in for <avr/eeprom.h>: EEPROM access to the simulated EEPROM
+ *
+ * License:
+ * This code is released under Creative Commons Legal Code CC0 1.0 Universal
+ *
+ * Contact:
+ * jr@htl-kaindorf.at
+ */
+
+#ifndef SIM_AVR_EEPROM_H_INCLUDED
+#define SIM_AVR_EEPROM_H_INCLUDED
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/****************************************************/
+// GLOBAL MACROS
+/****************************************************/
+
+// The simulated EEPROM completes every write immediately
+#define EEMEM
+#define eeprom_is_ready()   1
+#define eeprom_busy_wait()
+
+/****************************************************/
+// GLOBAL FUNCTIONS
+/****************************************************/
+
+uint8_t eeprom_read_byte(const uint8_t *address);
+uint16_t eeprom_read_word(const uint16_t *address);
+void eeprom_read_block(void *dst, const void *src, size_t n);
+void eeprom_write_byte(uint8_t *address, uint8_t value);
+void eeprom_write_word(uint16_t *address, uint16_t value);
+void eeprom_write_block(const void *src, void *dst, size_t n);
+void eeprom_update_byte(uint8_t *address, uint8_t value);
+void eeprom_update_word(uint16_t *address, uint16_t value);
+void eeprom_update_block(const void *src, void *dst, size_t n);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
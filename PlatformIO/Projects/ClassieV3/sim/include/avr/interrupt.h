@@ -0,0 +1,59 @@
+/*
+ * File:            interrupt.h
+ * Author:          Thomas Jerman
+ * Date Created:    18.10.2026
+ * Version: 1.0:    DD.MM.YYYY
+ * Last Modified:   DD.MM.YYYY
+ *
+ * Description:
+ * Native stand-in for <avr/interrupt.h>: ISRs become functions called by the simulation
+ *
+ * License:
+ * This code is released under Creative Commons Legal Code CC0 1.0 Universal
+ *
+ * Contact:
+ * jr@htl-kaindorf.at
+ */
+
+#ifndef SIM_AVR_INTERRUPT_H_INCLUDED
+#define SIM_AVR_INTERRUPT_H_INCLUDED
+
+#include <avr/io.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/****************************************************/
+// GLOBAL DEFINES
+/****************************************************/
+
+// Interrupt vectors, see sim.c for the vectors raised by the simulation
+#define INT0_vect           simInt0Vect
+#define INT1_vect           simInt1Vect
+#define TIMER2_COMPA_vect   simTimer2CompaVect
+#define TIMER2_OVF_vect     simTimer2OvfVect
+#define TIMER1_CAPT_vect    simTimer1CaptVect
+#define TIMER1_COMPA_vect   simTimer1CompaVect
+#define TIMER1_OVF_vect     simTimer1OvfVect
+#define TIMER0_OVF_vect     simTimer0OvfVect
+#define USART_RX_vect       simUsartRxVect
+#define USART_UDRE_vect     simUsartUdreVect
+#define USART_TX_vect       simUsartTxVect
+#define ADC_vect            simAdcVect
+#define EE_READY_vect       simEeReadyVect
+
+/****************************************************/
+// GLOBAL MACROS
+/****************************************************/
+
+#define ISR(vector, ...)    void vector(void); void vector(void)
+
+#define sei()               (SREG |= (1 << SREG_I))
+#define cli()               (SREG &= (uint8_t) ~(1 << SREG_I))
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,212 @@
+/*
+ * File:            io.h
+ * Author:          Thomas Jerman
+ * Date Created:    18.10.2026
+ * Version: 1.0:    DD.MM.YYYY
+ * Last Modified:   DD.MM.YYYY
+ *
+ * Description:
+ * Native stand-in for <avr/io.h>: ATmega328P registers mapped to the simulated register file
+ *
+ * License:
+ * This code is released under Creative Commons Legal Code CC0 1.0 Universal
+ *
+ * Contact:
+ * jr@htl-kaindorf.at
+ */
+
+#ifndef SIM_AVR_IO_H_INCLUDED
+#define SIM_AVR_IO_H_INCLUDED
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/****************************************************/
+// GLOBAL DEFINES
+/****************************************************/
+
+#define SIM_IO_SIZE     0x100   // data memory addresses of all special function registers
+
+#define _SFR_MEM8(address)      (*(volatile uint8_t *) &simIo[address])
+#define _SFR_MEM16(address)     (*(volatile uint16_t *) &simIo[address])
+#define _BV(bit)                (1 << (bit))
+
+#define RAMEND          0x08FF
+#define E2END           0x03FF
+
+// Port B, C, D
+#define PINB            _SFR_MEM8(0x23)
+#define DDRB            _SFR_MEM8(0x24)
+#define PORTB           _SFR_MEM8(0x25)
+#define PINC            _SFR_MEM8(0x26)
+#define DDRC            _SFR_MEM8(0x27)
+#define PORTC           _SFR_MEM8(0x28)
+#define PIND            _SFR_MEM8(0x29)
+#define DDRD            _SFR_MEM8(0x2A)
+#define PORTD           _SFR_MEM8(0x2B)
+#define PB0             0
+#define PB1             1
+#define PB2             2
+#define PB3             3
+#define PB4             4
+#define PB5             5
+#define PB6             6
+#define PB7             7
+
+// Interrupt flags
+#define TIFR0           _SFR_MEM8(0x35)
+#define TOV0            0
+#define OCF0A           1
+#define OCF0B           2
+#define TIFR1           _SFR_MEM8(0x36)
+#define TOV1            0
+#define OCF1A           1
+#define OCF1B           2
+#define ICF1            5
+#define TIFR2           _SFR_MEM8(0x37)
+#define TOV2            0
+#define OCF2A           1
+#define OCF2B           2
+#define PCIFR           _SFR_MEM8(0x3B)
+#define EIFR            _SFR_MEM8(0x3C)
+#define EIMSK           _SFR_MEM8(0x3D)
+#define GPIOR0          _SFR_MEM8(0x3E)
+
+// EEPROM
+#define EECR            _SFR_MEM8(0x3F)
+#define EERE            0
+#define EEPE            1
+#define EEMPE           2
+#define EERIE           3
+#define EEDR            _SFR_MEM8(0x40)
+#define EEAR            _SFR_MEM16(0x41)
+
+// Timer0
+#define TCCR0A          _SFR_MEM8(0x44)
+#define TCCR0B          _SFR_MEM8(0x45)
+#define TCNT0           _SFR_MEM8(0x46)
+#define OCR0A           _SFR_MEM8(0x47)
+#define OCR0B           _SFR_MEM8(0x48)
+
+// Sleep mode and MCU control, stack pointer and status register
+#define SMCR            _SFR_MEM8(0x53)
+#define SE              0
+#define SM0             1
+#define SM1             2
+#define SM2             3
+#define MCUSR           _SFR_MEM8(0x54)
+#define MCUCR           _SFR_MEM8(0x55)
+#define SP              _SFR_MEM16(0x5D)
+#define SREG            _SFR_MEM8(0x5F)
+#define SREG_I          7
+
+// Watchdog, clock and power reduction
+#define WDTCSR          _SFR_MEM8(0x60)
+#define CLKPR           _SFR_MEM8(0x61)
+#define PRR             _SFR_MEM8(0x64)
+#define OSCCAL          _SFR_MEM8(0x66)
+
+// Interrupt masks
+#define PCICR           _SFR_MEM8(0x68)
+#define EICRA           _SFR_MEM8(0x69)
+#define PCMSK0          _SFR_MEM8(0x6B)
+#define PCMSK1          _SFR_MEM8(0x6C)
+#define PCMSK2          _SFR_MEM8(0x6D)
+#define TIMSK0          _SFR_MEM8(0x6E)
+#define TOIE0           0
+#define OCIE0A          1
+#define OCIE0B          2
+#define TIMSK1          _SFR_MEM8(0x6F)
+#define TOIE1           0
+#define OCIE1A          1
+#define OCIE1B          2
+#define ICIE1           5
+#define TIMSK2          _SFR_MEM8(0x70)
+#define TOIE2           0
+#define OCIE2A          1
+#define OCIE2B          2
+
+// ADC
+#define ADC             _SFR_MEM16(0x78)
+#define ADCSRA          _SFR_MEM8(0x7A)
+#define ADCSRB          _SFR_MEM8(0x7B)
+#define ADMUX           _SFR_MEM8(0x7C)
+
+// Timer1
+#define TCCR1A          _SFR_MEM8(0x80)
+#define WGM10           0
+#define WGM11           1
+#define TCCR1B          _SFR_MEM8(0x81)
+#define CS10            0
+#define CS11            1
+#define CS12            2
+#define WGM12           3
+#define WGM13           4
+#define ICES1           6
+#define ICNC1           7
+#define TCCR1C          _SFR_MEM8(0x82)
+#define TCNT1           _SFR_MEM16(0x84)
+#define ICR1            _SFR_MEM16(0x86)
+#define OCR1A           _SFR_MEM16(0x88)
+#define OCR1B           _SFR_MEM16(0x8A)
+
+// Timer2
+#define TCCR2A          _SFR_MEM8(0xB0)
+#define WGM20           0
+#define WGM21           1
+#define TCCR2B          _SFR_MEM8(0xB1)
+#define CS20            0
+#define CS21            1
+#define CS22            2
+#define WGM22           3
+#define TCNT2           _SFR_MEM8(0xB2)
+#define OCR2A           _SFR_MEM8(0xB3)
+#define OCR2B           _SFR_MEM8(0xB4)
+#define ASSR            _SFR_MEM8(0xB6)
+
+// USART0
+#define UCSR0A          _SFR_MEM8(0xC0)
+#define MPCM0           0
+#define U2X0            1
+#define UPE0            2
+#define DOR0            3
+#define FE0             4
+#define UDRE0           5
+#define TXC0            6
+#define RXC0            7
+#define UCSR0B          _SFR_MEM8(0xC1)
+#define TXB80           0
+#define RXB80           1
+#define UCSZ02          2
+#define TXEN0           3
+#define RXEN0           4
+#define UDRIE0          5
+#define TXCIE0          6
+#define RXCIE0          7
+#define UCSR0C          _SFR_MEM8(0xC2)
+#define UCPOL0          0
+#define UCSZ00          1
+#define UCSZ01          2
+#define USBS0           3
+#define UPM00           4
+#define UPM01           5
+#define UMSEL00         6
+#define UMSEL01         7
+#define UBRR0           _SFR_MEM16(0xC4)
+#define UDR0            _SFR_MEM8(0xC6)
+
+/****************************************************/
+// GLOBAL STRUCT VARIABLE DECLARATION, INIT
+/****************************************************/
+
+// Simulated register file, indexed by data memory address
+extern volatile uint8_t simIo[SIM_IO_SIZE];
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
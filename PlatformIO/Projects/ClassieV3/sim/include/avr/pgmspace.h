@@ -0,0 +1,51 @@
+/*
+ * File:            pgmspace.h
+ * Author:          Thomas Jerman
+ * Date Created:    18.10.2026
+ * Version: 1.0:    DD.MM.YYYY
+ * Last Modified:   DD.MM.YYYY
+ *
+ * Description:
+ * Native stand-in for <avr/pgmspace.h>: program memory is ordinary memory
+ *
+ * License:
+ * This code is released under Creative Commons Legal Code CC0 1.0 Universal
+ *
+ * Contact:
+ * jr@htl-kaindorf.at
+ */
+
+#ifndef SIM_AVR_PGMSPACE_H_INCLUDED
+#define SIM_AVR_PGMSPACE_H_INCLUDED
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+/****************************************************/
+// GLOBAL MACROS
+/****************************************************/
+
+#define PROGMEM
+#define PGM_P               const char *
+#define PSTR(s)             (s)
+
+#define pgm_read_byte(p)    (*(const uint8_t *) (p))
+#define pgm_read_word(p)    (*(const uint16_t *) (p))
+#define pgm_read_dword(p)   (*(const uint32_t *) (p))
+#define pgm_read_ptr(p)     (*(void * const *) (p))
+
+#define printf_P            printf
+#define fprintf_P           fprintf
+#define sprintf_P           sprintf
+#define snprintf_P          snprintf
+#define puts_P              puts
+#define fputs_P             fputs
+#define strcmp_P            strcmp
+#define strncmp_P           strncmp
+#define strcpy_P            strcpy
+#define strlen_P            strlen
+#define memcpy_P            memcpy
+#define memcmp_P            memcmp
+
+#endif
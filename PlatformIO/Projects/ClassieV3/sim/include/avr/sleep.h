@@ -0,0 +1,53 @@
+/*
+ * File:            sleep.h
+ * Author:          Thomas Jerman
+ * Date Created:    18.10.2026
+ * Version: 1.0:    DD.MM.YYYY
+ * Last Modified:   DD.MM.YYYY
+ *
+ * Description:
+ * Native stand-in for <avr/sleep.h>: sleeping runs the pending simulated interrupts
+ *
+ * License:
+ * This code is released under Creative Commons Legal Code CC0 1.0 Universal
+ *
+ * Contact:
+ * jr@htl-kaindorf.at
+ */
+
+#ifndef SIM_AVR_SLEEP_H_INCLUDED
+#define SIM_AVR_SLEEP_H_INCLUDED
+
+#include <avr/io.h>
+
+#include "sim.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/****************************************************/
+// GLOBAL DEFINES
+/****************************************************/
+
+#define SLEEP_MODE_IDLE         (0)
+#define SLEEP_MODE_ADC          (1 << SM0)
+#define SLEEP_MODE_PWR_DOWN     (1 << SM1)
+#define SLEEP_MODE_PWR_SAVE     ((1 << SM0) | (1 << SM1))
+#define SLEEP_MODE_STANDBY      ((1 << SM1) | (1 << SM2))
+#define SLEEP_MODE_EXT_STANDBY  ((1 << SM0) | (1 << SM1) | (1 << SM2))
+
+/****************************************************/
+// GLOBAL MACROS
+/****************************************************/
+
+#define set_sleep_mode(mode)    (SMCR = (SMCR & (uint8_t) ~((1 << SM0) | (1 << SM1) | (1 << SM2))) | (mode))
+#define sleep_enable()          (SMCR |= (1 << SE))
+#define sleep_disable()         (SMCR &= (uint8_t) ~(1 << SE))
+#define sleep_cpu()             simService()
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,58 @@
+/*
+ * File:            wdt.h
+ * Author:          Thomas Jerman
+ * Date Created:    18.10.2026
+ * Version: 1.0:    DD.MM.YYYY
+ * Last Modified:   DD.MM.YYYY
+ *
+ * Description:
+ * Native stand-in for <avr/wdt.h>: a watchdog reset ends the simulation
+ *
+ * License:
+ * This code is released under Creative Commons Legal Code CC0 1.0 Universal
+ *
+ * Contact:
+ * jr@htl-kaindorf.at
+ */
+
+#ifndef SIM_AVR_WDT_H_INCLUDED
+#define SIM_AVR_WDT_H_INCLUDED
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/****************************************************/
+// GLOBAL DEFINES
+/****************************************************/
+
+#define WDTO_15MS           0
+#define WDTO_30MS           1
+#define WDTO_60MS           2
+#define WDTO_120MS          3
+#define WDTO_250MS          4
+#define WDTO_500MS          5
+#define WDTO_1S             6
+#define WDTO_2S             7
+
+/****************************************************/
+// GLOBAL MACROS
+/****************************************************/
+
+#define wdt_reset()
+#define wdt_disable()
+
+/****************************************************/
+// GLOBAL FUNCTIONS
+/****************************************************/
+
+// Terminates the simulation, as the target resets after the timeout
+void wdt_enable(uint8_t timeout);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,79 @@
+/*
+ * File:            sim.h
+ * Author:          Thomas Jerman
+ * Date Created:    18.10.2026
+ * Version: 1.0:    DD.MM.YYYY
+ * Last Modified:   DD.MM.YYYY
+ *
+ * Description:
+ * Providing the simulated ATmega328P used by the native build: register file,
+ * EEPROM, a UART fed from a byte stream and a capture of all transmitted bytes
+ *
+ * License:
+ * This code is released under Creative Commons Legal Code CC0 1.0 Universal
+ *
+ * Contact:
+ * jr@htl-kaindorf.at
+ */
+
+#ifndef SIM_H_INCLUDED
+#define SIM_H_INCLUDED
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#include <avr/io.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/****************************************************/
+// GLOBAL DEFINES
+/****************************************************/
+
+#define SIM_TX_CAPTURE_SIZE         4096    // transmitted bytes kept for inspection, older bytes are counted only
+
+/****************************************************/
+// GLOBAL STRUCT VARIABLE DECLARATION, INIT
+/****************************************************/
+
+// Standard output of the host, stdout is connected to the simulated UART by cliInit()
+extern FILE *simConsole;
+
+/****************************************************/
+// GLOBAL FUNCTIONS
+/****************************************************/
+
+// Reset the register file, erase the EEPROM and clear the UART capture
+void simInit();
+
+// Connect stdout to the character output function putChar
+void simStdoutInit(int (*putChar)(char, FILE *));
+
+// Run the pending interrupts: USART_UDRE_vect while enabled, EE_READY_vect while enabled
+// Nothing is done while the global interrupt flag is cleared
+void simService();
+
+// Receive length bytes through ISR(USART_RX_vect), the transmitter is serviced after each byte
+void simUartFeed(const void *data, size_t length);
+
+// Get the captured output since the last call of simUartClearOutput()
+// Return value: number of captured bytes, at most SIM_TX_CAPTURE_SIZE
+size_t simUartGetOutput(const char **data);
+
+// Clear the captured output
+void simUartClearOutput();
+
+// Get the number of bytes transmitted since simInit()
+uint32_t simUartGetTxCount();
+
+// Get the number of received bytes lost as the receiver or its interrupt was disabled
+uint32_t simUartGetRxLost();
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,53 @@
+/*
+ * File:            atomic.h
+ * Author:          Thomas Jerman
+ * Date Created:    18.10.2026
+ * Version: 1.0:    DD.MM.YYYY
+ * Last Modified:   DD.MM.YYYY
+ *
+ * Description:
+ * Native stand-in for <util/atomic.h>: masks the simulated interrupts while in the block
+ *
+ * License:
+ * This code is released under Creative Commons Legal Code CC0 1.0 Universal
+ *
+ * Contact:
+ * jr@htl-kaindorf.at
+ */
+
+#ifndef SIM_UTIL_ATOMIC_H_INCLUDED
+#define SIM_UTIL_ATOMIC_H_INCLUDED
+
+#include <avr/io.h>
+
+/****************************************************/
+// GLOBAL FUNCTIONS
+/****************************************************/
+
+static inline uint8_t simAtomicEnter(void)
+{
+    SREG &= (uint8_t) ~(1 << SREG_I);
+    return 1;
+}
+
+static inline void simAtomicRestore(const uint8_t *sreg)
+{
+    SREG = *sreg;
+}
+
+static inline void simAtomicForceOn(const uint8_t *sreg)
+{
+    (void) sreg;
+    SREG |= (1 << SREG_I);
+}
+
+/****************************************************/
+// GLOBAL MACROS
+/****************************************************/
+
+#define ATOMIC_RESTORESTATE uint8_t simSreg __attribute__((__cleanup__(simAtomicRestore))) = SREG
+#define ATOMIC_FORCEON      uint8_t simSreg __attribute__((__cleanup__(simAtomicForceOn))) = 0
+
+#define ATOMIC_BLOCK(type)  for (type, simToDo = simAtomicEnter(); simToDo; simToDo = 0)
+
+#endif
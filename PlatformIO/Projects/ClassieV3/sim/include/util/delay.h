@@ -0,0 +1,28 @@
+/*
+ * File:            delay.h
+ * Author:          Thomas Jerman
+ * Date Created:    18.10.2026
+ * Version: 1.0:    DD.MM.YYYY
+ * Last Modified:   DD.MM.YYYY
+ *
+ * Description:
+ * Native stand-in for <util/delay.h>: delays are skipped
+ *
+ * License:
+ * This code is released under Creative Commons Legal Code CC0 1.0 Universal
+ *
+ * Contact:
+ * jr@htl-kaindorf.at
+ */
+
+#ifndef SIM_UTIL_DELAY_H_INCLUDED
+#define SIM_UTIL_DELAY_H_INCLUDED
+
+/****************************************************/
+// GLOBAL MACROS
+/****************************************************/
+
+#define _delay_ms(ms)       ((void) (ms))
+#define _delay_us(us)       ((void) (us))
+
+#endif
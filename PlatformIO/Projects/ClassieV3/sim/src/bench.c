@@ -0,0 +1,580 @@
+/*
+ * File:            bench.c
+ * Author:          Thomas Jerman
+ * Date Created:    18.10.2026
+ *
+ * Description:
+ * Micro-benchmarks of the Classie shell on the simulated ATmega328P:
+ * bytes/s through the receive path, commands/s through dispatch and output bytes per command,
+ * conversions/s of snprintf_P() against the lean output module for the formats used by the shell,
+ * typed command lines against binary protocol requests in commands/s and link bytes per command.
+ * Each receive case is checked for the expected command line, so the escape sequence
+ * state machine of cliProcessRxData() is regression-tested on every run, the lean output is compared
+ * against snprintf_P() and each binary protocol response is decoded and checked
+ *
+ * Usage: program [ITERATIONS], returns 1 if a check fails
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include <avr/eeprom.h>
+#include <avr/io.h>
+#include <avr/pgmspace.h>
+#include <util/crc16.h>
+
+#include "appcmd.h"
+#include "cli.h"
+#include "cmd.h"
+#include "config.h"
+#include "journal.h"
+#include "out.h"
+#include "proto.h"
+#include "sim.h"
+
+/****************************************************/
+// LOCAL DEFINES
+/****************************************************/
+
+#define DEFAULT_ITERATIONS  10000
+#define PROMPT              "AVR>"
+#define CALLS_PER_BYTE      4       // cliProcessRxData() calls allowed per received byte before giving up
+#define LINK_BYTES_PER_S    7680    // bytes/s of the UART at 76800 baud, 8 data bits, 1 stop bit
+#define FRAME_SIZE_MAX      80      // encoded binary protocol request
+#define RESPONSE_HEADER     4       // SEQ, ID, TYPE and STATUS of a binary protocol response
+#define RESPONSE_SIZE_MAX   (RESPONSE_HEADER + PROTO_RESULT_MAX + 2)    // decoded response, CRC-16 included
+
+/****************************************************/
+// LOCAL STRUCT DEFINITION
+/****************************************************/
+
+// Number conversion measured by benchmarkOutput(), both functions format value into buffer
+struct OutputCase
+{
+    const char *format;
+    void (*printfConvert)(char *buffer, uint32_t value);
+    void (*outConvert)(char *buffer, uint32_t value);
+    uint32_t valueMax;                  // largest of outputValues compared, exact as float for %f
+};
+
+// Command line sent by benchmarkProtocol(), expectResult fills the result bytes of its response
+struct ProtocolCase
+{
+    const char *command;
+    uint8_t (*expectResult)(uint8_t *result);
+};
+
+// Command line typed into the terminal and the tokens expected after Enter
+struct RxCase
+{
+    const char *input;
+    const char *argv0;
+    uint8_t argc;
+};
+
+/****************************************************/
+// LOCAL STATIC STRUCT VARIABLE DECLARATION, INIT
+/****************************************************/
+
+static const struct RxCase rxCases[] =
+{
+    {"cd 1",                        "cd",   2},
+    {"sfr 2b ff wte",               "sfr",  4},
+    {"ce \"quoted param\" 0",       "ce",   3},
+    {"xc\e[D\e[D\e[C\e[C",          "xc",   1},     // cursor left and right
+    {"cdx\x7F 0",                   "cd",   2},     // backspace
+    {"eep\e[H\e[F 10",              "eep",  2},     // POS1 and END
+    {"  dc  ",                      "dc",   1},     // leading and trailing spaces
+};
+
+static const char *const dispatchCases[] =
+{
+    "cd", "ce", "ac", "dc", "rb", "clh", "sfr 2b", "eep 10", "cle", "tp", "unknown",
+};
+
+// Values compared by checkOutputCases(): zero, widths reached and overflowed, 16 and 32 bit limits
+static const uint32_t outputValues[] =
+{
+    0, 7, 9999, 10000, 65535, 65536, 1234567, 16777215, 268435456, 4294967295UL,
+};
+
+static uint8_t loginStatus = 1;
+
+static volatile char outputSink;        // keeps the conversions from being optimized away
+
+/****************************************************/
+// LOCAL FUNCTIONS
+/****************************************************/
+
+// Get monotonic time in nanoseconds
+static uint64_t now()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t) ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+// Type a command line followed by Enter and process it until cliProcessRxData() returns 1
+// Return value:    1: command line complete
+//                  0: not completed within CALLS_PER_BYTE calls per byte
+static uint8_t typeLine(const char *input)
+{
+    size_t length = strlen(input);
+    size_t calls = (length + 1) * CALLS_PER_BYTE;
+    simUartFeed(input, length);
+    simUartFeed("\r", 1);
+    while (calls--)
+        if (cliProcessRxData())
+            return 1;
+    return 0;
+}
+
+// Reset the command line for the next input, as the main loop does after each command
+static void printPrompt()
+{
+    cliPrintPrompt("", PROMPT, MAIN_LEVEL);
+    simService();
+    simUartClearOutput();
+}
+
+// Check all receive cases once
+// Return value: number of failed cases
+static uint8_t checkRxCases()
+{
+    uint8_t failed = 0;
+    for (size_t i = 0; i < sizeof(rxCases) / sizeof(rxCases[0]); i++)
+    {
+        const struct RxCase *rxCase = &rxCases[i];
+        const char *argv0 = NULL;
+        uint8_t complete = typeLine(rxCase->input);
+        if (complete)
+            argv0 = cliGetArgv(0);
+        if (!complete || argv0 == NULL || strcmp(argv0, rxCase->argv0) != 0 || cliGetArgc() != rxCase->argc)
+        {
+            fprintf(simConsole, "FAIL rx case %zu: expected \"%s\" argc %u, got \"%s\" argc %u%s\n",
+                i, rxCase->argv0, rxCase->argc, argv0 != NULL ? argv0 : "(null)", cliGetArgc(),
+                complete ? "" : ", line not completed");
+            failed++;
+        }
+        printPrompt();
+    }
+    return failed;
+}
+
+// Measure bytes/s through ISR(USART_RX_vect), cliProcessRxData() and the character echo
+static void benchmarkRx(uint32_t iterations)
+{
+    uint64_t bytes = 0, start = now(), elapsed;
+    for (uint32_t n = 0; n < iterations; n++)
+        for (size_t i = 0; i < sizeof(rxCases) / sizeof(rxCases[0]); i++)
+        {
+            typeLine(rxCases[i].input);
+            bytes += strlen(rxCases[i].input) + 1;
+            printPrompt();
+        }
+    elapsed = now() - start;
+    fprintf(simConsole, "Receive path:  %12.0f bytes/s (%llu bytes, prompt included)\n",
+        bytes * 1e9 / elapsed, (unsigned long long) bytes);
+}
+
+// Measure commands/s through cmdExecuteCommand() and the output bytes per command
+static void benchmarkDispatch(uint32_t iterations)
+{
+    fprintf(simConsole, "Dispatch:      %-10s %14s %14s\n", "command", "commands/s", "bytes/command");
+    for (size_t i = 0; i < sizeof(dispatchCases) / sizeof(dispatchCases[0]); i++)
+    {
+        uint64_t elapsed = 0;
+        uint32_t bytes = 0;
+        for (uint32_t n = 0; n < iterations; n++)
+        {
+            uint64_t start;
+            uint32_t txCount;
+            typeLine(dispatchCases[i]);
+            simService();
+            txCount = simUartGetTxCount();
+            start = now();
+            cmdExecuteCommand(&loginStatus);
+            simService();
+            elapsed += now() - start;
+            bytes += simUartGetTxCount() - txCount;
+            printPrompt();
+        }
+        fprintf(simConsole, "               %-10s %14.0f %14.1f\n",
+            dispatchCases[i], iterations * 1e9 / elapsed, (double) bytes / iterations);
+    }
+}
+
+// Conversions of benchmarkOutput(): padded decimal, fixed-point decimal and hexadecimal
+static void printfUnsigned(char *buffer, uint32_t value)
+{
+    snprintf_P(buffer, OUT_NUMBER_SIZE, PSTR("%4lu"), (unsigned long) value);
+}
+
+static void outUnsignedCase(char *buffer, uint32_t value)
+{
+    outFormatUnsigned(buffer, value, 4, ' ');
+}
+
+static void printfFixed(char *buffer, uint32_t value)
+{
+    snprintf_P(buffer, OUT_NUMBER_SIZE, PSTR("%9.1f"), (float) value);
+}
+
+static void outFixedCase(char *buffer, uint32_t value)
+{
+    outFormatFixed(buffer, value * 10, 1, 9);
+}
+
+static void printfHex(char *buffer, uint32_t value)
+{
+    snprintf_P(buffer, OUT_NUMBER_SIZE, PSTR("%04X"), (unsigned int) (value & 0xFFFF));
+}
+
+static void outHexCase(char *buffer, uint32_t value)
+{
+    outFormatHex(buffer, value, 4);
+}
+
+static const struct OutputCase outputCases[] =
+{
+    {"%4lu",    printfUnsigned, outUnsignedCase,    UINT32_MAX},
+    {"%9.1f",   printfFixed,    outFixedCase,       268435456},     // value * 10 fits 32 bit
+    {"%04X",    printfHex,      outHexCase,         UINT32_MAX},
+};
+
+// Check the lean output module against snprintf_P() for all values up to valueMax of each case
+// Return value: number of failed comparisons
+static uint8_t checkOutputCases()
+{
+    char expected[OUT_NUMBER_SIZE], actual[OUT_NUMBER_SIZE];
+    uint8_t failed = 0;
+
+    for (size_t i = 0; i < sizeof(outputCases) / sizeof(outputCases[0]); i++)
+        for (size_t v = 0; v < sizeof(outputValues) / sizeof(outputValues[0]); v++)
+        {
+            if (outputValues[v] > outputCases[i].valueMax)
+                continue;
+            outputCases[i].printfConvert(expected, outputValues[v]);
+            outputCases[i].outConvert(actual, outputValues[v]);
+            if (strcmp(expected, actual) != 0)
+            {
+                fprintf(simConsole, "FAIL output case %s of %lu: expected \"%s\", got \"%s\"\n",
+                    outputCases[i].format, (unsigned long) outputValues[v], expected, actual);
+                failed++;
+            }
+        }
+    return failed;
+}
+
+// Measure conversions/s of convert for values counting up from 0
+static double measureConversions(void (*convert)(char *buffer, uint32_t value), uint32_t iterations)
+{
+    char buffer[OUT_NUMBER_SIZE];
+    uint64_t start = now();
+    for (uint32_t n = 0; n < iterations; n++)
+    {
+        convert(buffer, n * 7);
+        outputSink = buffer[0];
+    }
+    return iterations * 1e9 / (now() - start);
+}
+
+// Measure conversions/s of snprintf_P() against the lean output module, after checking both format alike
+// Return value: number of failed comparisons
+static uint8_t benchmarkOutput(uint32_t iterations)
+{
+    uint8_t failed = checkOutputCases();
+
+    fprintf(simConsole, "Output:        %-10s %14s %14s\n", "format", "snprintf_P/s", "out/s");
+    for (size_t i = 0; i < sizeof(outputCases) / sizeof(outputCases[0]); i++)
+        fprintf(simConsole, "               %-10s %14.0f %14.0f\n", outputCases[i].format,
+            measureConversions(outputCases[i].printfConvert, iterations * 10),
+            measureConversions(outputCases[i].outConvert, iterations * 10));
+    return failed;
+}
+
+// COBS encode a binary protocol request of type with the command line into frame, the frame delimiter included
+// Return value: length of the encoded frame
+static size_t encodeRequest(uint8_t seq, uint8_t type, const char *command, uint8_t *frame)
+{
+    uint8_t request[FRAME_SIZE_MAX];
+    size_t length = 0, code = 0, out = 1;
+    uint16_t crc = 0;
+
+    request[length++] = seq;
+    request[length++] = seq;                // ID
+    request[length++] = type;
+    memcpy(request + length, command, strlen(command));
+    length += strlen(command);
+    for (size_t i = 0; i < length; i++)
+        crc = _crc_xmodem_update(crc, request[i]);
+    request[length++] = crc >> 8;
+    request[length++] = crc;
+    // frames of less than 254 bytes need no COBS block of code 0xFF
+    for (size_t i = 0; i < length; i++)
+    {
+        if (request[i] == 0)
+        {
+            frame[code] = out - code;
+            code = out++;
+        }
+        else
+            frame[out++] = request[i];
+    }
+    frame[code] = out - code;
+    frame[out++] = 0;
+    return out;
+}
+
+// Results of benchmarkProtocol() expected in the response: SFR 0x2B, EEPROM address 0x10 and none
+// Return value: number of result bytes
+static uint8_t expectSfr(uint8_t *result)
+{
+    result[0] = _SFR_MEM8(0x2B);
+    return 1;
+}
+
+static uint8_t expectEep(uint8_t *result)
+{
+    result[0] = eeprom_read_byte((const uint8_t *) 0x10);
+    return 1;
+}
+
+static uint8_t expectNone(uint8_t *result)
+{
+    return 0;
+}
+
+static const struct ProtocolCase protocolCases[] =
+{
+    {"sfr 2b",  expectSfr},
+    {"eep 10",  expectEep},
+    {"cd",      expectNone},
+};
+
+// COBS decode the first frame of the captured output into response and check its CRC-16
+// Return value: length of the frame decoded, CRC-16 included, 0 if no complete frame with a valid CRC was sent
+static size_t decodeResponse(uint8_t *response)
+{
+    const char *data;
+    size_t length = simUartGetOutput(&data), in = 0, out = 0;
+    uint16_t crc = 0;
+    uint8_t code;
+
+    while (in < length && data[in] != 0)
+    {
+        code = data[in++];
+        for (uint8_t i = 1; i < code; i++)
+        {
+            if (in == length || data[in] == 0 || out == RESPONSE_SIZE_MAX)
+                return 0;
+            response[out++] = data[in++];
+        }
+        // the zero ending a block shorter than 254 bytes is implied, except in front of the delimiter
+        if (code != 0xFF && in < length && data[in] != 0 && out < RESPONSE_SIZE_MAX)
+            response[out++] = 0;
+    }
+    if (in == length || out < RESPONSE_HEADER + 2)
+        return 0;
+    for (size_t i = 0; i < out; i++)
+        crc = _crc_xmodem_update(crc, response[i]);
+    return crc == 0 ? out : 0;
+}
+
+// Check the captured response of the command request id, seq counting the responses since binary mode was entered
+// Return value: NULL if it is the response expected, otherwise the first mismatch
+static const char *checkResponse(uint8_t seq, uint8_t id, const uint8_t *result, uint8_t resultLength)
+{
+    uint8_t response[RESPONSE_SIZE_MAX];
+    size_t length = decodeResponse(response);
+
+    if (length == 0)
+        return "no frame with a valid CRC";
+    if (response[0] != seq)
+        return "wrong SEQ";
+    if (response[1] != id)
+        return "ID not echoed";
+    if (response[2] != (PROTO_COMMAND | PROTO_RESPONSE))
+        return "wrong TYPE";
+    if (response[3] != PROTO_OK)
+        return "STATUS not PROTO_OK";
+    if (length != RESPONSE_HEADER + resultLength + 2 || memcmp(response + RESPONSE_HEADER, result, resultLength) != 0)
+        return "wrong result";
+    return NULL;
+}
+
+// Type the magic sequence switching to the binary protocol and read the acknowledge
+static void enterBinaryMode()
+{
+    simUartFeed(CLI_BINARY_MAGIC, strlen(CLI_BINARY_MAGIC));
+    while (!cliIsBinaryMode() && cliGetRxPending())
+        cliProcessRxData();
+    protoService(&loginStatus);
+    simService();
+    simUartClearOutput();
+}
+
+// Request to leave the binary protocol and reset the command line for the next input
+static void leaveBinaryMode()
+{
+    uint8_t frame[FRAME_SIZE_MAX];
+
+    simUartFeed(frame, encodeRequest(0, PROTO_EXIT, "", frame));
+    protoService(&loginStatus);
+    printPrompt();
+}
+
+// Send a binary protocol request and run protoService() until the response has been transmitted
+static void sendRequest(const uint8_t *frame, size_t length)
+{
+    simUartFeed(frame, length);
+    protoService(&loginStatus);
+    simService();
+}
+
+// Check that a repeated request is answered again without executing its command twice and that a
+// truncated frame is dropped without response, the next request being answered as usual
+// Return value: number of failed checks
+static uint8_t checkProtocolCases()
+{
+    uint8_t frame[FRAME_SIZE_MAX], result[1];
+    const char *mismatch;
+    size_t length;
+    uint8_t failed = 0;
+
+    enterBinaryMode();
+
+    // sfr returns the value read before writing, executed twice the repeated response would return 0x55
+    _SFR_MEM8(0x2B) = 0x00;
+    result[0] = 0x00;
+    length = encodeRequest(1, PROTO_COMMAND, "sfr 2b 55", frame);
+    for (uint8_t n = 0; n < 2; n++)
+    {
+        sendRequest(frame, length);
+        if ((mismatch = checkResponse(0, 1, result, 1)) != NULL)
+        {
+            fprintf(simConsole, "FAIL protocol case %s request: %s\n", n ? "repeated" : "first", mismatch);
+            failed++;
+        }
+        simUartClearOutput();
+    }
+
+    // the last byte in front of the frame delimiter is lost
+    length = encodeRequest(2, PROTO_COMMAND, "sfr 2b", frame);
+    frame[length - 2] = 0;
+    sendRequest(frame, length - 1);
+    if (simUartGetOutput(&mismatch) != 0)
+    {
+        fprintf(simConsole, "FAIL protocol case truncated request: answered\n");
+        failed++;
+    }
+    simUartClearOutput();
+    result[0] = 0x55;
+    length = encodeRequest(3, PROTO_COMMAND, "sfr 2b", frame);
+    sendRequest(frame, length);
+    if ((mismatch = checkResponse(1, 3, result, 1)) != NULL)
+    {
+        fprintf(simConsole, "FAIL protocol case request after truncated request: %s\n", mismatch);
+        failed++;
+    }
+    simUartClearOutput();
+
+    leaveBinaryMode();
+    return failed;
+}
+
+// Measure commands/s and the link bytes per command of typed command lines against binary protocol
+// requests, the link limits the commands/s to LINK_BYTES_PER_S divided by the larger direction, each
+// response is checked for the result expected
+// Return value: number of failed checks
+static uint8_t benchmarkProtocol(uint32_t iterations)
+{
+    uint8_t frame[FRAME_SIZE_MAX], result[PROTO_RESULT_MAX], resultLength;
+    const char *mismatch;
+    size_t length;
+    uint8_t failed = checkProtocolCases();
+
+    fprintf(simConsole, "Protocol:      %-10s %-7s %8s %8s %14s %14s\n",
+        "command", "mode", "in", "out", "commands/s", "link cmds/s");
+    for (size_t i = 0; i < sizeof(protocolCases) / sizeof(protocolCases[0]); i++)
+    {
+        uint64_t elapsed = 0, start;
+        uint32_t in = 0, out = 0, txCount, wrong = 0;
+        const char *command = protocolCases[i].command;
+
+        // typed: command line with Enter, echo, output and prompt
+        for (uint32_t n = 0; n < iterations; n++)
+        {
+            txCount = simUartGetTxCount();
+            start = now();
+            typeLine(command);
+            cmdExecuteCommand(&loginStatus);
+            cliPrintPrompt("", PROMPT, MAIN_LEVEL);
+            simService();
+            elapsed += now() - start;
+            in += strlen(command) + 1;
+            out += simUartGetTxCount() - txCount;
+            simUartClearOutput();
+        }
+        fprintf(simConsole, "               %-10s %-7s %8.1f %8.1f %14.0f %14.0f\n", command, "typed",
+            (double) in / iterations, (double) out / iterations, iterations * 1e9 / elapsed,
+            LINK_BYTES_PER_S / ((double) (in > out ? in : out) / iterations));
+
+        // binary: request and response frame
+        enterBinaryMode();
+        resultLength = protocolCases[i].expectResult(result);
+        elapsed = in = out = 0;
+        for (uint32_t n = 0; n < iterations; n++)
+        {
+            length = encodeRequest(n, PROTO_COMMAND, command, frame);
+            txCount = simUartGetTxCount();
+            start = now();
+            sendRequest(frame, length);
+            elapsed += now() - start;
+            in += length;
+            out += simUartGetTxCount() - txCount;
+            // SEQ and ID of the request are n, the responses are counted alike from entering binary mode
+            if ((mismatch = checkResponse(n, n, result, resultLength)) != NULL && wrong++ == 0)
+                fprintf(simConsole, "FAIL protocol case %s: %s in response %lu\n", command, mismatch, (unsigned long) n);
+            simUartClearOutput();
+        }
+        failed += wrong != 0;
+        fprintf(simConsole, "               %-10s %-7s %8.1f %8.1f %14.0f %14.0f\n", "", "binary",
+            (double) in / iterations, (double) out / iterations, iterations * 1e9 / elapsed,
+            LINK_BYTES_PER_S / ((double) (in > out ? in : out) / iterations));
+        leaveBinaryMode();
+    }
+    return failed;
+}
+
+/****************************************************/
+// GLOBAL FUNCTIONS
+/****************************************************/
+
+// main-Function
+int main(int argc, char **argv)
+{
+    uint32_t iterations = argc > 1 ? strtoul(argv[1], NULL, 0) : DEFAULT_ITERATIONS;
+    uint8_t failed;
+
+    simInit();
+    cliInit(76800);
+    journalInit();
+    cfgInit();
+    appCmdRegister();
+    printPrompt();
+
+    fprintf(simConsole, "Classie native benchmark, %lu iterations\n", (unsigned long) iterations);
+    failed = checkRxCases();
+    benchmarkRx(iterations);
+    benchmarkDispatch(iterations);
+    failed += benchmarkOutput(iterations);
+    failed += benchmarkProtocol(iterations);
+    if (simUartGetRxLost() != 0 || cliGetRxOverruns() != 0)
+        fprintf(simConsole, "Receive bytes lost: %lu, overruns: %u\n", (unsigned long) simUartGetRxLost(), cliGetRxOverruns());
+
+    fprintf(simConsole, "%s: %u checks failed\n", failed ? "FAILED" : "PASSED", failed);
+    return failed ? EXIT_FAILURE : EXIT_SUCCESS;
+}
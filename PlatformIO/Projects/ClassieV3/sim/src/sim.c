@@ -0,0 +1,232 @@
+/*
+ * File:            sim.c
+ * Author:          Thomas Jerman
+ * Date Created:    18.10.2026
+ *
+ * Description:
+ * Providing the simulated ATmega328P used by the native build: register file,
+ * EEPROM, a UART fed from a byte stream and a capture of all transmitted bytes
+ */
+
+#define _GNU_SOURCE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <avr/eeprom.h>
+#include <avr/interrupt.h>
+#include <avr/io.h>
+#include <avr/wdt.h>
+
+#include "sim.h"
+
+/****************************************************/
+// LOCAL DEFINES
+/****************************************************/
+
+#define EEPROM_ADDRESS(address)     ((uintptr_t) (address) & E2END)
+
+/****************************************************/
+// LOCAL STRUCT DEFINITION
+/****************************************************/
+
+// Declaration of the simulation struct
+struct Sim
+{
+    uint8_t eeprom[E2END + 1];              // simulated EEPROM
+    char txCapture[SIM_TX_CAPTURE_SIZE];    // captured output
+    size_t txCaptureLength;                 // number of bytes in txCapture
+    uint32_t txCount;                       // bytes transmitted since simInit()
+    uint32_t rxLost;                        // received bytes lost
+    int (*putChar)(char, FILE *);           // character output function connected to stdout
+    FILE *stdoutStream;                     // stream connected to putChar
+};
+
+/****************************************************/
+// LOCAL STATIC STRUCT VARIABLE DECLARATION, INIT
+/****************************************************/
+
+static struct Sim this;
+
+/****************************************************/
+// GLOBAL STRUCT VARIABLE DECLARATION, INIT
+/****************************************************/
+
+volatile uint8_t simIo[SIM_IO_SIZE];
+FILE *simConsole = NULL;
+
+/****************************************************/
+// LOCAL FUNCTIONS
+/****************************************************/
+
+// Interrupt service routines of the Classie modules raised by the simulation
+void simUsartRxVect(void);
+void simUsartUdreVect(void);
+void simEeReadyVect(void);
+
+// Write function of the stream connected to stdout
+static ssize_t writeStdout(void *cookie, const char *buf, size_t size)
+{
+    for (size_t i = 0; i < size; i++)
+        this.putChar(buf[i], this.stdoutStream);
+    return size;
+}
+
+// Hand over the byte written to UDR0 to the capture
+static void transmit()
+{
+    if (this.txCaptureLength < SIM_TX_CAPTURE_SIZE)
+        this.txCapture[this.txCaptureLength++] = UDR0;
+    this.txCount++;
+}
+
+/****************************************************/
+// GLOBAL FUNCTIONS
+/****************************************************/
+
+// Reset the register file, erase the EEPROM and clear the UART capture
+void simInit()
+{
+    if (simConsole == NULL)
+        simConsole = stdout;
+    memset((void *) simIo, 0, SIM_IO_SIZE);
+    memset(this.eeprom, 0xFF, sizeof(this.eeprom));
+    this.txCaptureLength = 0;
+    this.txCount = 0;
+    this.rxLost = 0;
+    // the transmitter is always ready, every byte is transmitted immediately
+    UCSR0A = (1 << UDRE0);
+}
+
+// Connect stdout to the character output function putChar
+void simStdoutInit(int (*putChar)(char, FILE *))
+{
+    cookie_io_functions_t functions = {NULL, writeStdout, NULL, NULL};
+    if (this.stdoutStream == NULL)
+    {
+        this.stdoutStream = fopencookie(NULL, "w", functions);
+        setvbuf(this.stdoutStream, NULL, _IONBF, 0);
+    }
+    this.putChar = putChar;
+    stdout = this.stdoutStream;
+}
+
+// Run the pending interrupts: USART_UDRE_vect while enabled, EE_READY_vect while enabled
+// Nothing is done while the global interrupt flag is cleared
+void simService()
+{
+    if (!(SREG & (1 << SREG_I)))
+        return;
+    while (UCSR0B & (1 << UDRIE0))
+    {
+        simUsartUdreVect();
+        transmit();
+    }
+    while (EECR & (1 << EERIE))
+        simEeReadyVect();
+}
+
+// Receive length bytes through ISR(USART_RX_vect), the transmitter is serviced after each byte
+void simUartFeed(const void *data, size_t length)
+{
+    const uint8_t *bytes = (const uint8_t *) data;
+    while (length--)
+    {
+        if ((UCSR0B & (1 << RXEN0)) && (UCSR0B & (1 << RXCIE0)) && (SREG & (1 << SREG_I)))
+        {
+            UDR0 = *bytes;
+            UCSR0A |= (1 << RXC0);
+            simUsartRxVect();
+            UCSR0A &= (uint8_t) ~(1 << RXC0);
+        }
+        else
+            this.rxLost++;
+        bytes++;
+        simService();
+    }
+}
+
+// Get the captured output since the last call of simUartClearOutput()
+// Return value: number of captured bytes, at most SIM_TX_CAPTURE_SIZE
+size_t simUartGetOutput(const char **data)
+{
+    *data = this.txCapture;
+    return this.txCaptureLength;
+}
+
+// Clear the captured output
+void simUartClearOutput()
+{
+    this.txCaptureLength = 0;
+}
+
+// Get the number of bytes transmitted since simInit()
+uint32_t simUartGetTxCount()
+{
+    return this.txCount;
+}
+
+// Get the number of received bytes lost as the receiver or its interrupt was disabled
+uint32_t simUartGetRxLost()
+{
+    return this.rxLost;
+}
+
+/****************************************************/
+// AVR-LIBC STAND-INS
+/****************************************************/
+
+uint8_t eeprom_read_byte(const uint8_t *address)
+{
+    return this.eeprom[EEPROM_ADDRESS(address)];
+}
+
+uint16_t eeprom_read_word(const uint16_t *address)
+{
+    return eeprom_read_byte((const uint8_t *) address) | (eeprom_read_byte((const uint8_t *) address + 1) << 8);
+}
+
+void eeprom_read_block(void *dst, const void *src, size_t n)
+{
+    for (size_t i = 0; i < n; i++)
+        ((uint8_t *) dst)[i] = eeprom_read_byte((const uint8_t *) src + i);
+}
+
+void eeprom_write_byte(uint8_t *address, uint8_t value)
+{
+    this.eeprom[EEPROM_ADDRESS(address)] = value;
+}
+
+void eeprom_write_word(uint16_t *address, uint16_t value)
+{
+    eeprom_write_byte((uint8_t *) address, (uint8_t) value);
+    eeprom_write_byte((uint8_t *) address + 1, (uint8_t) (value >> 8));
+}
+
+void eeprom_write_block(const void *src, void *dst, size_t n)
+{
+    for (size_t i = 0; i < n; i++)
+        eeprom_write_byte((uint8_t *) dst + i, ((const uint8_t *) src)[i]);
+}
+
+void eeprom_update_byte(uint8_t *address, uint8_t value)
+{
+    eeprom_write_byte(address, value);
+}
+
+void eeprom_update_word(uint16_t *address, uint16_t value)
+{
+    eeprom_write_word(address, value);
+}
+
+void eeprom_update_block(const void *src, void *dst, size_t n)
+{
+    eeprom_write_block(src, dst, n);
+}
+
+void wdt_enable(uint8_t timeout)
+{
+    fprintf(simConsole, "\nsim: watchdog reset\n");
+    exit(EXIT_SUCCESS);
+}
@@ -0,0 +1,134 @@
+/*
+ * File:            appcmd.c
+ * Author:          Thomas Jerman
+ * Date Created:    18.10.2026
+ *
+ * Description:
+ * Providing the application commands
+ */
+
+#include <stdio.h>
+
+#include <avr/io.h>
+#include <avr/pgmspace.h>
+#include <util/atomic.h>
+
+#include "cli.h"
+#include "cmd.h"
+#include "appcmd.h"
+#include "nec.h"
+#include "out.h"
+#include "timer1.h"
+
+/****************************************************/
+// LOCAL DEFINES
+/****************************************************/
+
+#define APPLICATION_COMMANDS_COUNT  (sizeof(applicationCommands) / sizeof(applicationCommands[0]))
+#define INCAP_EDGES                 NEC_CAPTURE_ARRAY_SIZE  // edges captured by incap
+
+/****************************************************/
+// LOCAL STRUCT DEFINITION
+/****************************************************/
+
+// Declaration of the application command struct, state of resumable commands shared by all CLI instances
+struct AppCmd
+{
+    volatile uint32_t *captureArray;    // capture array lent by the NEC receiver during incap, 0 if not lent
+    uint8_t edge;                       // next edge printed by incap
+};
+
+/****************************************************/
+// LOCAL STATIC STRUCT VARIABLE DECLARATION, INIT
+/****************************************************/
+
+static struct AppCmd this;
+
+/****************************************************/
+// LOCAL MACROS
+/****************************************************/
+
+/****************************************************/
+// LOCAL FUNCTIONS
+/****************************************************/
+
+// Get the captured time of edge, 0 if not captured yet
+static uint32_t getCapture(uint8_t edge)
+{
+    uint32_t capture;
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+        capture = this.captureArray[edge];
+    return capture;
+}
+
+// Print each edge once captured by ISR(TIMER1_CAPT_vect), the NEC receiver resumes afterwards
+static uint8_t stepIncap(struct CmdThread *thread, uint8_t *login_status)
+{
+    CMD_BEGIN(thread);
+    for (this.edge = 0; this.edge < INCAP_EDGES; this.edge++)
+    {
+        CMD_WAIT_UNTIL(thread, getCapture(this.edge) != 0);
+        #ifdef OUT_PRINTF_FLT
+        if (this.edge % 2 == 0) {
+            printf_P(PSTR("%3d: L: %9.1f us"), this.edge, ((float) getCapture(this.edge)));
+        } else {
+            printf_P(PSTR(", H: %9.1f us\n"), ((float) getCapture(this.edge)));
+        }
+        #else
+        // same output as %9.1f from the captured microseconds in tenths
+        if (this.edge % 2 == 0) {
+            outUnsigned(this.edge, 3);
+            outString_P(PSTR(": L: "));
+        } else {
+            outString_P(PSTR(", H: "));
+        }
+        outFixed(getCapture(this.edge) * 10, 1, 9);
+        outString_P(this.edge % 2 == 0 ? PSTR(" us") : PSTR(" us\n"));
+        #endif
+    }
+    printf_P(PSTR("\n"));
+    necStartReceiving();
+    this.captureArray = 0;
+    CMD_END(thread);
+}
+
+// Hand back the input capture to the NEC receiver on Ctrl+C
+static void cancelIncap(uint8_t *login_status)
+{
+    necStartReceiving();
+    this.captureArray = 0;
+}
+
+// incap = input capture of 67 edges at ICP1 (PB0)
+static void executeIncap(uint8_t *login_status)
+{
+    // ICP1 has a single capture unit, another CLI instance may be capturing already
+    if (this.captureArray) {
+        printf_P(PSTR("Input capture busy: incap running on another CLI instance\n"));
+        return;
+    }
+    printf_P(PSTR("Capturing ICP1 (PB0), Ctrl+C to cancel ...\n"));
+
+    // borrow the capture array of the NEC receiver, which stops decoding meanwhile
+    this.captureArray = necStopReceiving();
+    for (uint8_t edge = 0; edge < INCAP_EDGES; edge++)
+        this.captureArray[edge] = 0;
+    timer1StartInputCapture(this.captureArray, INCAP_EDGES);
+    cmdResume(stepIncap, cancelIncap);
+}
+
+// Application command table, sorted by name for binary search
+static const struct CmdEntry applicationCommands[] PROGMEM =
+{
+    {"incap", executeIncap, CMD_USER,   0,  "Input capture at ICP1 (PB0)",  "-"},
+};
+
+/****************************************************/
+// GLOBAL FUNCTIONS
+/****************************************************/
+
+// Register the application command table using cmdSetApplicationCommands
+void appCmdRegister()
+{
+    cmdSetApplicationCommands(applicationCommands, APPLICATION_COMMANDS_COUNT);
+}
@@ -4,7 +4,7 @@
  * Date Created:    20.05.2023
  *
  * Description:
- * Providing a Command Line Interface using the AVR-UART
+ * Providing a Command Line Interface using the AVR-UART, one independent instance per USART bound
  */
 
 #include <stdio.h>
@@ -14,16 +14,33 @@
 #include <avr/io.h>
 #include <avr/interrupt.h>
 #include <avr/pgmspace.h>
+#include <util/atomic.h>
 #include <util/delay.h>
 
 #include "cli.h"
+#include "clock.h"
+#include "event.h"
+#include "hal.h"
 
 /****************************************************/
 // LOCAL DEFINES
 /****************************************************/
 
 #define SIZE REC_CHAR_MAX + 1           // Do not set SIZE to more than REC_CHAR_MAX + 1
-#define DELAY 255                       // Delay to slow down fast data transmitting of controller, 255 = max.
+#define RX_MASK (RX_BUF_SIZE - 1)       // index mask of the receive ring buffer
+#define TX_MASK (TX_BUF_SIZE - 1)       // index mask of the transmit ring buffer
+
+#if (RX_BUF_SIZE & RX_MASK) != 0 || RX_BUF_SIZE > 512
+#error "RX_BUF_SIZE must be a power of two up to 512"
+#endif
+
+#if (TX_BUF_SIZE & TX_MASK) != 0 || TX_BUF_SIZE > 256
+#error "TX_BUF_SIZE must be a power of two up to 256"
+#endif
+
+#if CLI_HIST_SIZE > 255 || CLI_HIST_ENTRIES < 1
+#error "CLI_HIST_SIZE must not exceed 255 bytes, CLI_HIST_ENTRIES must be at least 1"
+#endif
 
 /****************************************************/
 // LOCAL STRUCT DEFINITION
@@ -35,56 +52,99 @@ struct Cli
     int rcvIndex;                       // receive index
     int rcvIndexMax;                    // maximum receive index
     char rcvBuf[SIZE];                  // receive buffer
+    char tokBuf[SIZE + 1];              // copy of rcvBuf with '\0' terminated tokens at their original offsets
+    struct CliToken tokens[TOKENS_MAX]; // token descriptors built once per command line by tokenize()
+    uint8_t argc;                       // number of valid token descriptors
+    uint8_t nextToken;                  // index of the token returned by the next call of cliGetNextToken()
     char rcvChar;                       // received char
-    int ringBufIndex;                   // ring buffer index
-    char ringBuf[SIZE];                 // ring buffer
+    volatile uint16_t rxHead;           // receive ring buffer write index, set by ISR(USART_RX_vect)
+    volatile uint16_t rxTail;           // receive ring buffer read index, set by cliProcessRxData()
+    char ringBuf[RX_BUF_SIZE];          // receive ring buffer
+    volatile unsigned int rxOverruns;   // counts characters lost due to a full ring buffer or UART data overrun
+    volatile unsigned int rxFrameErrors;// counts characters discarded due to framing or parity errors
     char pwdChar;                       // password character
     char escSeqState;                   // escape sequence state machine
-    char histBuf[SIZE];                 // history buffer
-    int histIndex;                      // index to last processed cmd
-    int lastCmdIndex;                   // index of last command
+    #if defined(UART_ISR_CHARACTER_ECHOING) && defined(CURSOR_HIDING)
+    unsigned char hideCursorFlag;       // 1 while the cursor is hidden to redraw the command line after an edit
+    #endif
+    char histBuf[CLI_HIST_SIZE];        // history buffer, commands stored oldest first without terminator
+    uint8_t histOffset[CLI_HIST_ENTRIES];   // position of each command in histBuf, oldest first
+    uint8_t histCount;                  // number of commands in the history
+    uint8_t histUsed;                   // bytes of histBuf used by the commands
+    uint8_t histRecall;                 // commands recalled counted back from the newest, 0: new command line
+    uint8_t histChanges;                // incremented on each change of the history
     char ctrlKey;                       // variable to save received CTRL-Key
     char *pCtrlKey;                     // pointer to handle CTRL-Keys
     unsigned char statusBarFlag;        // saves print status bar flag
     unsigned int lineFeedCounter;       // counts the number of sent line feeds
+    uint8_t outputLines;                // line feeds sent since cliMarkOutput(), saturating
     unsigned char promptLength;         // length of prompt
     void (*cliStatusBarSetup)(void);    // function pointer to be set to the user implemented status bar setup function
+    const struct CliStatusField *statusFields;  // status bar fields in program memory, NULL if cliStatusBarSetup is used
+    uint8_t statusFieldsCount;          // number of status bar fields
+    uint8_t statusBarRows;              // number of status bar rows printed by the fields
+    char statusShadow[CLI_STATUS_SHADOW_SIZE];  // field values shown in the terminal, without '\0'
+    uint16_t statusInterval;            // minimum time between two status bar updates in ms
+    uint32_t statusLastUpdate;          // clockMillis() of the last status bar update
+    uint8_t terminalRows;               // terminal rows in scroll region mode, 0 prints the status bar above each prompt
+    uint8_t scrollRegion;               // 1 while the status bar rows are excluded from scrolling
+    char txBuf[TX_BUF_SIZE];            // transmit ring buffer, emptied by ISR(USART_UDRE_vect)
+    volatile uint8_t txHead;            // transmit ring buffer write index
+    volatile uint8_t txTail;            // transmit ring buffer read index
+    unsigned char txPolicy;             // TX_BLOCKING or TX_NON_BLOCKING
+    unsigned int txDropped;             // counts characters dropped due to a full transmit ring buffer
+    uint8_t binaryMode;                 // 1 while the binary protocol owns the USART, text output is dropped
+    uint8_t magicMatched;               // characters of CLI_BINARY_MAGIC received in a row
+    #if CLI_USARTS > 1
+    volatile uint8_t *usart;            // UCSRnA of the USART bound, followed by UCSRnB, UCSRnC, UBRRn and UDRn
+    #endif
 };
 
 /****************************************************/
 // LOCAL STATIC STRUCT VARIABLE DECLARATION, INIT
 /****************************************************/
 
-static struct Cli this;
+static struct Cli instances[CLI_INSTANCES];
+
+#if CLI_INSTANCES > 1
+static struct Cli *selected = &instances[0];    // instance the CLI functions work on, set by cliSelect()
+#endif
+
+#if CLI_USARTS > 1
+// Register blocks of the USARTs, each starting with UCSRnA
+static volatile uint8_t * const usartBase[CLI_USARTS] = {&UCSR0A, &UCSR1A, &UCSR2A, &UCSR3A};
+
+// Instance bound to each USART, served by the ISRs of the USART
+static struct Cli *usartInstances[CLI_USARTS];
+#endif
 
 /****************************************************/
 // LOCAL MACROS
 /****************************************************/
 
-#define moveCursorForward(t, o)         \
-{                                       \
-    sendWhenReady('\e');                \
-    sendWhenReady('[');                 \
-    sendWhenReady(t);                   \
-    sendWhenReady(o);                   \
-    sendWhenReady('C');                 \
-}
-
-#define moveCursorPreviousLine(t, o)    \
-{                                       \
-    sendWhenReady('\e');                \
-    sendWhenReady('[');                 \
-    sendWhenReady(t);                   \
-    sendWhenReady(o);                   \
-    sendWhenReady('F');                 \
-}
-
-#define clearUserInput()                \
-{                                       \
-    sendWhenReady('\e');                \
-    sendWhenReady('[');                 \
-    sendWhenReady('K');                 \
-}
+#define clearUserInput()                txWrite("\e[K", 3)
+
+// The CLI functions work on the instance selected, a single instance is addressed directly
+#if CLI_INSTANCES > 1
+#define this                            (*selected)
+#else
+#define this                            instances[0]
+#endif
+
+// Registers of the USART bound to instance, the USART0 registers if there is no other USART
+#if CLI_USARTS > 1
+#define usartA(instance)                ((instance).usart[0])
+#define usartB(instance)                ((instance).usart[1])
+#define usartC(instance)                ((instance).usart[2])
+#define usartBaud(instance)             (*(volatile uint16_t *) &(instance).usart[4])
+#define usartData(instance)             ((instance).usart[6])
+#else
+#define usartA(instance)                UCSR0A
+#define usartB(instance)                UCSR0B
+#define usartC(instance)                UCSR0C
+#define usartBaud(instance)             UBRR0
+#define usartData(instance)             UDR0
+#endif
 
 /****************************************************/
 // LOCAL FUNCTIONS
@@ -97,51 +157,407 @@ void defaultStatusBarSetup()
     printf_P(PSTR("to call your custom FUNCTION to setup the contents of the status bar to be displayed     \n" TXT_RESET_FORMAT));
 }
 
+// Put a character into the transmit ring buffer and enable the UART Data Register Empty Interrupt
+void txPut(char send_byte)
+{
+    uint8_t head = (this.txHead + 1) & TX_MASK;
+    // text would corrupt the frames of the binary protocol
+    if (this.binaryMode)
+        return;
+    // Ring buffer is full
+    while (head == this.txTail)
+    {
+        if (this.txPolicy == TX_NON_BLOCKING)
+        {
+            this.txDropped++;
+            return;
+        }
+        // ISR(USART_UDRE_vect) cannot empty the ring buffer with global interrupts disabled,
+        // so hand over the oldest character to the UART directly
+        if (!(SREG & (1 << SREG_I)) && (usartA(this) & (1 << UDRE0)))
+        {
+            usartData(this) = this.txBuf[this.txTail];
+            this.txTail = (this.txTail + 1) & TX_MASK;
+        }
+        HAL_BUSY_WAIT();
+    }
+    this.txBuf[this.txHead] = send_byte;
+    this.txHead = head;
+    usartB(this) |= (1 << UDRIE0);
+}
+
+// Put length characters into the transmit ring buffer with a single index update,
+// characters not fitting into the free space are handed over to txPut() one by one
+void txWrite(const char *data, uint8_t length)
+{
+    uint8_t head = this.txHead;
+    uint8_t space = (this.txTail - head - 1) & TX_MASK;
+
+    if (this.binaryMode)
+        return;
+    if (length > space)
+    {
+        while (length--)
+            txPut(*data++);
+        return;
+    }
+    while (length--)
+    {
+        this.txBuf[head] = *data++;
+        head = (head + 1) & TX_MASK;
+    }
+    this.txHead = head;
+    usartB(this) |= (1 << UDRIE0);
+}
+
 // Configure standard output stream to use UART
 int uartPutchar(char send_byte, FILE *stream)
 {
-    // Wait for empty transmit buffer
-    while (!(UCSR0A & (1 << UDRE0)));
-    // Send character
-    UDR0 = send_byte;
+    // Queue character for ISR driven sending
+    txPut(send_byte);
     // Count line feeds sent to control status bar printing
     if (send_byte == '\n')
+    {
         this.lineFeedCounter++;
+        if (this.outputLines < 0xFF)
+            this.outputLines++;
+    }
+    return 0;
+}
+
+// Configure standard output stream to use UART without counting line feeds, used in scroll region mode
+int txPutchar(char send_byte, FILE *stream)
+{
+    txPut(send_byte);
+    if (send_byte == '\n' && this.outputLines < 0xFF)
+        this.outputLines++;
     return 0;
 }
 
-// Restore UART buffer after command and parameters have been read
-// Set all '\0' introduced by strtok back to ' '
-void restoreBuffer()
+// Split the received command line in a single pass into space separated tokens, strings
+// under quotes are one token. Tokens are copied to this.tokBuf at their original offset and
+// terminated by '\0', so this.rcvBuf stays untouched and every token is accessible in O(1)
+void tokenize()
 {
-    for (int i = 0; i < SIZE - 1; i++)
-        if (this.rcvBuf[i] == '\0')
-            this.rcvBuf[i] = ' ';
-    this.rcvBuf[SIZE - 1] = '\n';
+    uint8_t i = 0, quoted;
+    char c;
+
+    this.argc = 0;
+    this.nextToken = 1;
+    while (i < SIZE && (c = this.rcvBuf[i]) != '\0' && c != '\n' && this.argc < TOKENS_MAX)
+    {
+        // separators between tokens
+        if (c == ' ' || c == '\r')
+        {
+            this.tokBuf[i++] = '\0';
+            continue;
+        }
+        // opening quote is not part of the token
+        if ((quoted = (c == '"')))
+            this.tokBuf[i++] = '\0';
+        this.tokens[this.argc].offset = i;
+        this.tokens[this.argc].quoted = quoted;
+        while (i < SIZE && (c = this.rcvBuf[i]) != '\0' && c != '\n' &&
+               (quoted ? c != '"' : (c != ' ' && c != '\r')))
+            this.tokBuf[i++] = c;
+        this.tokens[this.argc].length = i - this.tokens[this.argc].offset;
+        this.argc++;
+        // closing quote is not part of the token
+        if (quoted && i < SIZE && c == '"')
+            this.tokBuf[i++] = '\0';
+    }
+    this.tokBuf[i] = '\0';
 }
 
-// Send byte if UART is available
+// Send byte using the transmit ring buffer
 void sendWhenReady(unsigned char send_byte)
 {
-    while (!(UCSR0A & (1 << UDRE0)));
-            UDR0 = send_byte;
-    for (volatile uint8_t i = 0; i < DELAY; i++);
+    txPut(send_byte);
+}
+
+// Write n as decimal number without leading zeros to buffer
+// Return value:    number of characters written
+static uint8_t formatDecimal(char *buffer, uint8_t n)
+{
+    uint8_t length = 0;
+    if (n >= 100)
+        buffer[length++] = '0' + n / 100;
+    if (n >= 10)
+        buffer[length++] = '0' + (n / 10) % 10;
+    buffer[length++] = '0' + n % 10;
+    return length;
+}
+
+// Send the control sequence ESC [ n final, e.g. final 'A' moves the cursor n lines up
+static void sendCsi(uint8_t n, char final)
+{
+    char sequence[6] = {'\e', '['};
+    uint8_t length = 2 + formatDecimal(sequence + 2, n);
+    sequence[length++] = final;
+    txWrite(sequence, length);
+}
+
+// Send the control sequence ESC [ first ; second final
+static void sendCsi2(uint8_t first, uint8_t second, char final)
+{
+    char sequence[10] = {'\e', '['};
+    uint8_t length = 2 + formatDecimal(sequence + 2, first);
+    sequence[length++] = ';';
+    length += formatDecimal(sequence + length, second);
+    sequence[length++] = final;
+    txWrite(sequence, length);
+}
+
+// Move the cursor columns to the right or -columns to the left with one control sequence
+static void moveCursor(int8_t columns)
+{
+    if (columns > 1)
+        sendCsi(columns, 'C');
+    else if (columns < -1)
+        sendCsi(-columns, 'D');
+    else if (columns != 0)
+        txWrite(columns > 0 ? "\e[C" : "\e[D", 3);
+}
+
+// Rewrite the command line from this.rcvIndex after characters were deleted at this.rcvIndex,
+// erasing the remaining characters of the former line, and move the cursor back to this.rcvIndex
+static void rewriteAfterDeletion()
+{
+    uint8_t length = this.rcvIndexMax - this.rcvIndex;
+    txWrite(this.rcvBuf + this.rcvIndex, length);
+    clearUserInput();
+    moveCursor(-length);
+}
+
+// Format the value of field padded with spaces to its width into value, without '\0'
+static void formatStatusField(const struct CliStatusField *field, char *value)
+{
+    char buffer[CLI_STATUS_VALUE_SIZE];
+    uint8_t length;
+
+    buffer[0] = '\0';
+    if (field->format != NULL)
+        field->format(buffer, sizeof(buffer), field->arg);
+    length = strlen(buffer);
+    if (length > field->width)
+        length = field->width;
+    memcpy(value, buffer, length);
+    memset(value + length, ' ', field->width - length);
+}
+
+// Print all status bar rows with labels and values, the printed rows are counted by uartPutchar()
+// In scroll region mode each row is printed at its position on top of the screen without line feed
+static void printStatusFields()
+{
+    char line[CLI_STATUS_BAR_WIDTH + 1];   // row followed by a line feed
+    struct CliStatusField field;
+    uint8_t shadow;
+
+    printf_P(PSTR(TXT_COLOR_REVERSE));
+    for (uint8_t row = 0; row < this.statusBarRows; row++)
+    {
+        memset(line, ' ', CLI_STATUS_BAR_WIDTH);
+        shadow = 0;
+        for (uint8_t index = 0; index < this.statusFieldsCount; index++)
+        {
+            memcpy_P(&field, &this.statusFields[index], sizeof(field));
+            if (field.row == row)
+            {
+                uint8_t labelLength = strlen(field.label);
+                memcpy(line + field.column, field.label, labelLength);
+                formatStatusField(&field, this.statusShadow + shadow);
+                memcpy(line + field.column + labelLength, this.statusShadow + shadow, field.width);
+            }
+            shadow += field.width;
+        }
+        if (this.scrollRegion)
+        {
+            sendCsi2(row + 1, 1, 'H');
+            cliWrite(line, CLI_STATUS_BAR_WIDTH);
+        }
+        else
+        {
+            line[CLI_STATUS_BAR_WIDTH] = '\n';
+            cliWrite(line, CLI_STATUS_BAR_WIDTH + 1);
+        }
+    }
+    printf_P(PSTR(TXT_RESET_FORMAT));
+}
+
+// Redraw the values of all status bar fields which changed since they were printed
+// The cursor is moved relative to the prompt line, the status bar rows are followed by
+// lineFeeds - this.statusBarRows lines, lineFeeds is at most CLI_STATUS_BAR_REACH. In scroll region
+// mode the cursor is saved and positioned absolutely as the status bar rows never scroll
+static void updateStatusFields(uint8_t lineFeeds, unsigned char hideCursor)
+{
+    char value[CLI_STATUS_VALUE_SIZE];
+    struct CliStatusField field;
+    uint8_t shadow = 0;
+    uint8_t moved = 0;                  // 1 once the cursor left the prompt line
+    uint8_t up = 0;                     // lines the cursor is above the prompt line
+
+    for (uint8_t index = 0; index < this.statusFieldsCount; index++)
+    {
+        memcpy_P(&field, &this.statusFields[index], sizeof(field));
+        formatStatusField(&field, value);
+        if (memcmp(value, this.statusShadow + shadow, field.width) != 0)
+        {
+            uint8_t column = field.column + strlen(field.label) + 1;
+            if (!moved)
+            {
+                moved = 1;
+                if (hideCursor)
+                    cliHideCursor();
+                if (this.scrollRegion)
+                    printf_P(PSTR(SAVE_CURSOR));
+                printf_P(PSTR(TXT_COLOR_REVERSE));
+            }
+            if (this.scrollRegion)
+                sendCsi2(field.row + 1, column, 'H');
+            else
+            {
+                uint8_t target = lineFeeds - field.row;
+                if (target > up)
+                    sendCsi(target - up, 'A');
+                else if (target < up)
+                    sendCsi(up - target, 'B');
+                up = target;
+                sendCsi(column, 'G');
+            }
+            for (uint8_t i = 0; i < field.width; i++)
+                sendWhenReady(this.statusShadow[shadow + i] = value[i]);
+        }
+        shadow += field.width;
+    }
+    if (moved)
+    {
+        // back to where the cursor was before updating the status bar
+        printf_P(PSTR(TXT_RESET_FORMAT));
+        if (this.scrollRegion)
+            printf_P(PSTR(RESTORE_CURSOR));
+        else
+        {
+            sendCsi(up, 'B');
+            sendCsi(this.promptLength + this.rcvIndex + 1, 'G');
+        }
+        if (hideCursor)
+            cliShowCursor();
+    }
+}
+
+// Set or reset the scroll region below the status bar rows, the text on the screen is kept
+// The terminal cannot report the cursor row, so the screen is scrolled to have free rows below
+// the cursor before moving its contents down to make room for the status bar rows
+static void setScrollRegion(uint8_t enable)
+{
+    uint8_t rows = this.statusBarRows;
+
+    if (enable == this.scrollRegion)
+        return;
+    if (enable)
+    {
+        for (uint8_t i = 0; i < rows; i++)
+            sendWhenReady('\n');
+        sendCsi(rows, 'A');
+        printf_P(PSTR(SAVE_CURSOR CURSOR_TO_UPPER_LEFT_POS));
+        sendCsi(rows, 'L');
+        printf_P(PSTR(RESTORE_CURSOR));
+        sendCsi(rows, 'B');
+        printf_P(PSTR(SAVE_CURSOR));
+        sendCsi2(rows + 1, this.terminalRows, 'r');
+        this.scrollRegion = 1;
+        printStatusFields();
+        printf_P(PSTR(RESTORE_CURSOR));
+        // command output no longer has to be counted
+        HAL_STDOUT_INIT(txPutchar);
+    }
+    else
+    {
+        // the status bar rows stay on the screen and scroll away with the next output
+        printf_P(PSTR(SAVE_CURSOR RESET_SCROLL_REGION RESTORE_CURSOR));
+        this.scrollRegion = 0;
+        this.lineFeedCounter = 0;
+        HAL_STDOUT_INIT(uartPutchar);
+    }
+}
+
+// Set the scroll region while the status bar flag, fields and terminal rows call for it
+static void applyScrollRegion()
+{
+    setScrollRegion(this.statusBarFlag == 1 && this.statusFields != NULL &&
+                    this.terminalRows > this.statusBarRows);
 }
 
-// Set cursor on step right
-void setCursorRight()
+// Get the length of the history entry index, 0 is the oldest command
+static uint8_t getHistoryLength(uint8_t index)
 {
-    sendWhenReady('\e');
-    sendWhenReady('[');
-    sendWhenReady('C');
+    uint8_t end = index + 1 < this.histCount ? this.histOffset[index + 1] : this.histUsed;
+    return end - this.histOffset[index];
 }
 
-// Set cursor on step left
-void setCursorLeft()
+// Remove the history entry index and move all newer commands to the front
+static void removeHistoryEntry(uint8_t index)
 {
-    sendWhenReady('\e');
-    sendWhenReady('[');
-    sendWhenReady('D');
+    uint8_t offset = this.histOffset[index];
+    uint8_t length = getHistoryLength(index);
+
+    memmove(this.histBuf + offset, this.histBuf + offset + length, this.histUsed - offset - length);
+    for (uint8_t i = index; i + 1 < this.histCount; i++)
+        this.histOffset[i] = this.histOffset[i + 1] - length;
+    this.histCount--;
+    this.histUsed -= length;
+}
+
+// Replace the command line by the next older (direction 1) or newer (direction -1) command of the history,
+// the newest command is followed by an empty command line
+static void recallHistory(int8_t direction)
+{
+    uint8_t recall = this.histRecall + direction;
+
+    // recall wraps to 255 below the empty command line
+    if (recall > this.histCount)
+        return;
+    this.histRecall = recall;
+
+    // move cursor to the very left input position and delete all input characters shown in terminal
+    moveCursor(-this.rcvIndex);
+    clearUserInput();
+    memset(this.rcvBuf, 0, this.rcvIndexMax);
+    this.rcvIndexMax = 0;
+
+    // echo the recalled command line at once
+    if (recall)
+    {
+        uint8_t index = this.histCount - recall;
+        this.rcvIndexMax = getHistoryLength(index);
+        memcpy(this.rcvBuf, this.histBuf + this.histOffset[index], this.rcvIndexMax);
+        txWrite(this.rcvBuf, this.rcvIndexMax);
+    }
+    this.rcvIndex = this.rcvIndexMax;
+}
+
+// Switch to the binary protocol once the control characters of CLI_BINARY_MAGIC are received in a row,
+// matched of them right before the character received, the line typed so far is discarded and text output
+// is dropped from now on
+static void matchBinaryMagic(uint8_t matched)
+{
+    static const char magic[] PROGMEM = CLI_BINARY_MAGIC;
+
+    // the characters of the magic sequence are distinct, a mismatch can only restart the match
+    if (this.rcvChar != (char) pgm_read_byte(&magic[matched]))
+        matched = 0;
+    if (this.rcvChar != (char) pgm_read_byte(&magic[matched]))
+        return;
+    if (++matched < sizeof(magic) - 1)
+    {
+        this.magicMatched = matched;
+        return;
+    }
+    memset(this.rcvBuf, 0, SIZE);
+    this.rcvIndex = 0;
+    this.rcvIndexMax = 0;
+    this.escSeqState = 0;
+    this.binaryMode = 1;
 }
 
 /****************************************************/
@@ -152,40 +568,54 @@ void setCursorLeft()
 // Using 8 bit data and 1 stop bit and no parity
 void cliInit(uint32_t bps)
 {
+    cliInitInstance(0, 0, bps);
+}
+
+// Initialize the CLI instance bound to USART usart (0 to CLI_USARTS - 1) with custom bitrate and select it,
+// cliInit() initializes instance 0 bound to USART0
+void cliInitInstance(uint8_t instance, uint8_t usart, uint32_t bps)
+{
+    if (instance >= CLI_INSTANCES || usart >= CLI_USARTS)
+        return;
+
     // disable global interrupt
     cli(); // is equivalent to  SREG |= SREG_I;
 
+    #if CLI_INSTANCES > 1
+    selected = &instances[instance];
+    #endif
+    #if CLI_USARTS > 1
+    this.usart = usartBase[usart];
+    usartInstances[usart] = &this;
+    #endif
+
     /****************************************************/
     // UART-SETUP
     /****************************************************/
 
     // Configure stdout to be connected to UART
-    static FILE uartStdout = FDEV_SETUP_STREAM(uartPutchar, NULL, _FDEV_SETUP_WRITE);
-    stdout = &uartStdout;
+    HAL_STDOUT_INIT(uartPutchar);
     
-    // set baud rate
-    if (bps <= 115200)
-        UBRR0 = (uint16_t)(((F_CPU / (bps * 8UL))) - 1);
-    else
-        UBRR0 = 0x10;       //115200 with U2X0 set
+    // set baud rate for double speed mode, rounded to the nearest UBRRn value
+    usartBaud(this) = (uint16_t)(((F_CPU / 8UL + bps / 2) / bps) - 1);
 
     // set double baudrate bit
-    UCSR0A |= (1 << U2X0);
+    usartA(this) |= (1 << U2X0);
 
     // set asynchronous mode
-    UCSR0C &= ~((1 << UMSEL01) | (1 << UMSEL00));
+    usartC(this) &= ~((1 << UMSEL01) | (1 << UMSEL00));
 
     // set EVEN paritiy 
-    //UCSR0C |= (1 << UPM01);
+    //usartC(this) |= (1 << UPM01);
 
     // set 2 stop bit
-    //UCSR0C |= (1 << USBS0);
+    //usartC(this) |= (1 << USBS0);
 
     // set 8 data bits
-    UCSR0C |= ((1 << UCSZ01) | (1 << UCSZ00));
+    usartC(this) |= ((1 << UCSZ01) | (1 << UCSZ00));
 
-    // enable transmitter and receiver
-    UCSR0B |= (1 << RXEN0) | (1 << TXEN0);
+    // enable transmitter, receiver and RX Complete Interrupt
+    usartB(this) |= (1 << RXEN0) | (1 << TXEN0) | (1 << RXCIE0);
 
     /****************************************************/
     // STRUCT INITIALIZATION
@@ -193,23 +623,46 @@ void cliInit(uint32_t bps)
 
     // set UART.rcvBuf to be zero
     memset(this.rcvBuf, 0, SIZE);
-    memset(this.histBuf, 0, SIZE);
-    memset(this.ringBuf, 0, SIZE);
+    memset(this.tokBuf, 0, SIZE + 1);
+    memset(this.ringBuf, 0, RX_BUF_SIZE);
 
     // set struct variables
     this.rcvIndex = 0;
-    this.ringBufIndex = 0;
+    this.argc = 0;
+    this.nextToken = 1;
+    this.rxHead = 0;
+    this.rxTail = 0;
+    this.rxOverruns = 0;
+    this.rxFrameErrors = 0;
     this.rcvIndexMax = 0;
     this.pwdChar = '\0';
     this.escSeqState = 0;
+    #if defined(UART_ISR_CHARACTER_ECHOING) && defined(CURSOR_HIDING)
+    this.hideCursorFlag = 0;
+    #endif
     this.ctrlKey = 0;
     this.pCtrlKey = NULL;
-    this.histIndex = SIZE - 1;
-    this.lastCmdIndex = SIZE - 1;
+    this.histCount = 0;
+    this.histUsed = 0;
+    this.histRecall = 0;
+    this.histChanges = 0;
     this.statusBarFlag = 0;     // saves print status bar flag
     this.lineFeedCounter = 0;   // counts the number of sent line feeds
     this.promptLength = 0;      // length of prompt
     this.cliStatusBarSetup = defaultStatusBarSetup;
+    this.statusFields = NULL;
+    this.statusFieldsCount = 0;
+    this.statusBarRows = 0;
+    this.statusInterval = CLI_STATUS_INTERVAL;
+    this.statusLastUpdate = 0;
+    this.terminalRows = 0;
+    this.scrollRegion = 0;
+    this.txHead = 0;
+    this.txTail = 0;
+    this.txPolicy = TX_BLOCKING;
+    this.txDropped = 0;
+    this.binaryMode = 0;
+    this.magicMatched = 0;
 
     // enable global interrupt
     sei(); // is equivalent to  SREG |= SREG_I;
@@ -217,10 +670,185 @@ void cliInit(uint32_t bps)
     _delay_ms(100);
 }
 
+// Select the initialized CLI instance all other CLI functions work on and connect stdout to its USART
+void cliSelect(uint8_t instance)
+{
+    #if CLI_INSTANCES > 1
+    if (instance >= CLI_INSTANCES || selected == &instances[instance])
+        return;
+    selected = &instances[instance];
+    // command output is counted unless the status bar rows are excluded from scrolling, see setScrollRegion()
+    if (this.scrollRegion)
+    {
+        HAL_STDOUT_INIT(txPutchar);
+    }
+    else
+    {
+        HAL_STDOUT_INIT(uartPutchar);
+    }
+    #endif
+}
+
+// Get the CLI instance selected
+uint8_t cliGetInstance()
+{
+    #if CLI_INSTANCES > 1
+    return selected - instances;
+    #else
+    return 0;
+    #endif
+}
+
+// Set the policy for writing to a full transmit ring buffer: TX_BLOCKING or TX_NON_BLOCKING
+void cliSetTxPolicy(unsigned char txPolicy)
+{
+    this.txPolicy = txPolicy == TX_NON_BLOCKING ? TX_NON_BLOCKING : TX_BLOCKING;
+}
+
+// Get the number of characters waiting in the transmit ring buffer
+unsigned int cliGetTxPending()
+{
+    return (this.txHead - this.txTail) & TX_MASK;
+}
+
+// Get the number of received characters waiting in the receive ring buffer
+unsigned int cliGetRxPending()
+{
+    uint16_t rxHead;
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+        rxHead = this.rxHead;
+    return (rxHead - this.rxTail) & RX_MASK;
+}
+
+// Read a byte of the receive ring buffer bypassing the command line editing, used by the binary protocol
+// Return value:    1: byte read
+//                  0: receive ring buffer empty
+uint8_t cliReadByte(uint8_t *byte)
+{
+    uint16_t rxHead;
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+        rxHead = this.rxHead;
+    if (this.rxTail == rxHead)
+        return 0;
+    *byte = this.ringBuf[this.rxTail];
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+        this.rxTail = (this.rxTail + 1) & RX_MASK;
+    return 1;
+}
+
+// Get the number of characters dropped due to a full transmit ring buffer
+unsigned int cliGetTxDropped()
+{
+    return this.txDropped;
+}
+
+// Write length characters straight into the transmit ring buffer, bypassing stdout
+// Line feeds are counted like those printed through stdout
+void cliWrite(const char *data, uint8_t length)
+{
+    txWrite(data, length);
+    for (uint8_t i = 0; i < length; i++)
+        if (data[i] == '\n')
+        {
+            // uartPutchar() counts the line feeds for the status bar printed above the prompt
+            if (!this.scrollRegion)
+                this.lineFeedCounter++;
+            if (this.outputLines < 0xFF)
+                this.outputLines++;
+        }
+}
+
+// Switch to the binary protocol (1), text output is dropped, or back to the command line (0)
+void cliSetBinaryMode(uint8_t enable)
+{
+    this.binaryMode = enable ? 1 : 0;
+}
+
+// Get if the binary protocol owns the USART, entered on receiving CLI_BINARY_MAGIC
+uint8_t cliIsBinaryMode()
+{
+    return this.binaryMode;
+}
+
+// Write length bytes of a binary protocol frame into the transmit ring buffer, text output stays dropped
+void cliWriteBinary(const void *data, uint8_t length)
+{
+    this.binaryMode = 0;
+    txWrite((const char *) data, length);
+    this.binaryMode = 1;
+}
+
+// Wait until all characters in the transmit ring buffer have been handed over to the UART
+void cliFlushTx()
+{
+    while (this.txHead != this.txTail)
+    {
+        // empty the ring buffer without ISR(USART_UDRE_vect) if global interrupts are disabled
+        if (!(SREG & (1 << SREG_I)) && (usartA(this) & (1 << UDRE0)))
+        {
+            usartData(this) = this.txBuf[this.txTail];
+            this.txTail = (this.txTail + 1) & TX_MASK;
+        }
+        HAL_BUSY_WAIT();
+    }
+    while (!(usartA(this) & (1 << UDRE0)));
+}
+
+// Get the number of tokens (command and parameters) of the received command line
+uint8_t cliGetArgc()
+{
+    return this.argc;
+}
+
+// Get token by index as '\0' terminated string: index 0 = command, 1.. = parameters
+// Strings under quotes are one single token. Return value: NULL if index >= cliGetArgc()
+char *cliGetArgv(uint8_t index)
+{
+    if (index < this.argc)
+        return this.tokBuf + this.tokens[index].offset;
+    return NULL;
+}
+
+// Get the descriptor (offset, length, quoted) of the token at index
+// Return value: NULL if index >= cliGetArgc()
+const struct CliToken *cliGetToken(uint8_t index)
+{
+    if (index < this.argc)
+        return &this.tokens[index];
+    return NULL;
+}
+
+// Set the command line to length characters received by other means than typing, e.g. by the binary
+// protocol, and split it into tokens, characters beyond REC_CHAR_MAX are ignored
+void cliSetCommandLine(const char *line, uint8_t length)
+{
+    if (length > REC_CHAR_MAX)
+        length = REC_CHAR_MAX;
+    memcpy(this.rcvBuf, line, length);
+    memset(this.rcvBuf + length, 0, SIZE - length);
+    this.rcvIndex = length;
+    this.rcvIndexMax = length;
+    this.ctrlKey = 0;
+    tokenize();
+}
+
+// Drop the first count tokens, so the token at index count becomes the command
+// Return value: number of tokens left
+uint8_t cliShiftArgv(uint8_t count)
+{
+    if (count > this.argc)
+        count = this.argc;
+    this.argc -= count;
+    memmove(this.tokens, this.tokens + count, this.argc * sizeof(this.tokens[0]));
+    this.nextToken = 1;
+    return this.argc;
+}
+
 // Get first token (spaced separated substring) from reveived string
 char *cliGetFirstToken()
 {
-    return strtok(this.rcvBuf, " \r\n");
+    this.nextToken = 1;
+    return cliGetArgv(0);
 }
 
 // Get next token on each consecutive call of this function, which
@@ -228,16 +856,7 @@ char *cliGetFirstToken()
 // Make sure to check if param != NULL after each function call of cliGetNextToken()
 char *cliGetNextToken()
 {
-    char *p = strtok(NULL, " \r\n"); // tokenize on next space character
-    if (*p == '"')                   // check for a quote character
-    {
-        *strchr(p++, '\0') = ' '; // restore space character
-        p = strtok(p, "\"\r\n");  // tokenize on next quote character
-    }
-    if (p < this.rcvBuf + SIZE)
-        return p;
-    else
-        return NULL;
+    return cliGetArgv(this.nextToken++);
 }
 
 // Print and process received command and all parameters available
@@ -266,17 +885,12 @@ unsigned char cliPrintCmdDetails()
     unsigned char paramCount = 0;
     if (this.rcvIndex != 0 && this.rcvBuf[0] >= ' ')
     {
-        char *p;
-        if ((p = cliGetFirstToken()) != NULL)
-            printf_P(PSTR("Command: [%s]\n"), p);
-        else
+        if (this.argc == 0)
             return 0;
-        do
-        {
-            if ((p = cliGetNextToken()) != NULL && p < this.rcvBuf + SIZE - 1)
-                printf_P(PSTR("Param#%X: [%s]\n"), ++paramCount, p);
-        } while (p != NULL);
-        restoreBuffer();
+        printf_P(PSTR("Command: [%s]\n"), cliGetArgv(0));
+        while (++paramCount < this.argc)
+            printf_P(PSTR("Param#%X: [%s]\n"), paramCount, cliGetArgv(paramCount));
+        paramCount--;
     }
     return paramCount;
 }
@@ -287,24 +901,12 @@ void cliPrintCmdHistory()
     #ifdef UART_ISR_CHARACTER_ECHOING
     #ifdef HIST_BUFFER_PRINTING
 
-    int j = 0;
-    uint8_t offset = 0;
-    char histBufChar;
-    if (this.histIndex != this.lastCmdIndex)
+    if (this.histCount)
     {
         printf_P(PSTR("Command history:  "));
-        while(j < SIZE)
-        {
-            if (++j + this.histIndex > SIZE - 1)
-                offset = SIZE;
-            histBufChar = this.histBuf[j + this.histIndex - offset];
-            if (histBufChar >= ' ')
-                printf_P(PSTR("%c"), histBufChar);
-            else if (histBufChar == '\n')
-                printf_P(PSTR(", "));
-        }
-        // delete output of last printf
-        printf_P(PSTR("\b\b  \n"));
+        for (uint8_t index = 0; index < this.histCount; index++)
+            printf_P(index ? PSTR(", %.*s") : PSTR("%.*s"), getHistoryLength(index), this.histBuf + this.histOffset[index]);
+        printf_P(PSTR("\n"));
     }
 
     #endif  //HIST_BUFFER_PRINTING
@@ -316,22 +918,25 @@ void cliPrintCmdHistory()
 void cliPrintPrompt(const char promptFormating[], const char prompt[], int promptLevel)
 {
     memset(this.rcvBuf, 0, SIZE);
-    this.rcvIndex = UDR0; // read buffered UDR0 to empty it once
-    this.rcvIndex = UDR0; // read buffered UDR0 to empty it twice
+    this.argc = 0;
     this.rcvIndex = 0;
     this.rcvIndexMax = 0;
     this.rcvChar = 0;
     this.ctrlKey = 0;
     this.pCtrlKey = NULL;
     this.escSeqState = 0;
-    if (cliGetStatusBarFlag() == 1 && promptLevel == 0)
+    this.histRecall = 0;
+    if (cliGetStatusBarFlag() == 1 && promptLevel == 0 && !this.scrollRegion)
     {
         this.lineFeedCounter = 0;
-        this.cliStatusBarSetup();
+        if (this.statusFields != NULL)
+            printStatusFields();
+        else
+            this.cliStatusBarSetup();
     }
     this.promptLength = strlen(prompt);
     printf_P(PSTR("%s%s" TXT_RESET_FORMAT SHOW_CURSOR), promptFormating, prompt);
-    UCSR0B |= (1 << RXEN0); // enable the UART receiver
+    usartB(this) |= (1 << RXEN0); // enable the UART receiver
 }
 
 // Enable UART password character '*'
@@ -355,7 +960,7 @@ int cliEnableCtrlKeys(char *pCtrlKey)
     if(pCtrlKey)
     {
         this.pCtrlKey = pCtrlKey;
-        UCSR0B |= (1 << RXEN0);
+        usartB(this) |= (1 << RXEN0);
         return 1;
     }
     printf_P(PSTR("Error: null pointer not accepted to enable CTRL-Keys.\n"));
@@ -371,31 +976,68 @@ char cliGetCtrlKey()
 // Clear Command History
 void cliClearCmdHistory()
 {
-    memset(this.histBuf, 0, SIZE);
-    this.histIndex = SIZE - 1;
-    this.lastCmdIndex = SIZE - 1;
+    this.histCount = 0;
+    this.histUsed = 0;
+    this.histRecall = 0;
+    this.histChanges++;
+}
+
+// Append a command of length characters to the history, an identical older command is removed
+// The oldest commands are dropped while CLI_HIST_ENTRIES or CLI_HIST_SIZE would be exceeded
+void cliAddHistoryEntry(const char *command, uint8_t length)
+{
+    if (length == 0 || length > CLI_HIST_SIZE)
+        return;
+    for (uint8_t index = 0; index < this.histCount; index++)
+        if (getHistoryLength(index) == length && memcmp(this.histBuf + this.histOffset[index], command, length) == 0)
+        {
+            // repeating the newest command leaves the history unchanged
+            if (index + 1 == this.histCount)
+                return;
+            removeHistoryEntry(index);
+            break;
+        }
+    while (this.histCount == CLI_HIST_ENTRIES || CLI_HIST_SIZE - this.histUsed < length)
+        removeHistoryEntry(0);
+    this.histOffset[this.histCount++] = this.histUsed;
+    memcpy(this.histBuf + this.histUsed, command, length);
+    this.histUsed += length;
+    this.histChanges++;
+}
+
+// Get the number of commands in the history
+uint8_t cliGetHistoryCount()
+{
+    return this.histCount;
+}
+
+// Get a command of the history without '\0', index 0 is the oldest command
+// Return value:    pointer to the command, its number of characters is written to length
+//                  NULL if index is out of range
+const char *cliGetHistoryEntry(uint8_t index, uint8_t *length)
+{
+    if (index >= this.histCount)
+        return NULL;
+    *length = getHistoryLength(index);
+    return this.histBuf + this.histOffset[index];
+}
+
+// Get a counter incremented on each change of the history, e.g. to detect commands to be saved
+uint8_t cliGetHistoryChanges()
+{
+    return this.histChanges;
 }
 
 // Hide Cursor
 void cliHideCursor()
 {
-    sendWhenReady('\e');
-    sendWhenReady('[');
-    sendWhenReady('?');
-    sendWhenReady('2');
-    sendWhenReady('5');
-    sendWhenReady('l');
+    txWrite(HIDE_CURSOR, sizeof(HIDE_CURSOR) - 1);
 }
 
 // Show Cursor
 void cliShowCursor()
 {
-    sendWhenReady('\e');
-    sendWhenReady('[');
-    sendWhenReady('?');
-    sendWhenReady('2');
-    sendWhenReady('5');
-    sendWhenReady('h');
+    txWrite(SHOW_CURSOR, sizeof(SHOW_CURSOR) - 1);
 }
 
 // Set status bar flag
@@ -405,6 +1047,7 @@ void cliSetStatusBarFlag(unsigned char statusBarFlagNew)
         this.statusBarFlag = 1;
     else
         this.statusBarFlag = 0;
+    applyScrollRegion();
 }
 
 // Get status bar flag
@@ -422,16 +1065,121 @@ void cliSetStatusBar(void (*userStatusBarSetup)(void))
         this.cliStatusBarSetup = defaultStatusBarSetup;
 }
 
+// Set the status bar fields stored in program memory (PROGMEM) replacing the status bar setup function
+// Only fields whose value changed are redrawn by cliPrintStatusBar()
+// Return value:    1: fields set
+//                  0: fields exceed CLI_STATUS_BAR_WIDTH, CLI_STATUS_VALUE_SIZE or CLI_STATUS_SHADOW_SIZE
+uint8_t cliSetStatusFields(const struct CliStatusField *fields, uint8_t count)
+{
+    struct CliStatusField field;
+    uint16_t shadowSize = 0;
+    uint8_t rows = 0;
+
+    for (uint8_t index = 0; index < count; index++)
+    {
+        memcpy_P(&field, &fields[index], sizeof(field));
+        if (field.width >= CLI_STATUS_VALUE_SIZE ||
+            field.column + strlen(field.label) + field.width > CLI_STATUS_BAR_WIDTH)
+            return 0;
+        shadowSize += field.width;
+        if (field.row >= rows)
+            rows = field.row + 1;
+    }
+    if (shadowSize > CLI_STATUS_SHADOW_SIZE)
+        return 0;
+    setScrollRegion(0);
+    this.statusFields = fields;
+    this.statusFieldsCount = count;
+    this.statusBarRows = rows;
+    applyScrollRegion();
+    return 1;
+}
+
+// Set the minimum time between two status bar updates in ms
+void cliSetStatusBarInterval(uint16_t interval)
+{
+    this.statusInterval = interval;
+}
+
+// Reserve the status bar rows at the top of a terminal with terminalRows rows using a scroll region,
+// command output scrolls below the status bar, which is updated in place without counting line feeds
+// The scroll region is set while the status bar flag is set, terminalRows 0 prints the status bar above each prompt
+// Return value:    1: terminal rows set
+//                  0: terminalRows leaves no row below the status bar fields
+uint8_t cliSetStatusScrollRegion(uint8_t terminalRows)
+{
+    if (terminalRows != 0 && terminalRows <= this.statusBarRows)
+        return 0;
+    if (this.scrollRegion && terminalRows != 0)
+    {
+        // only the bottom margin changes, the status bar stays where it is
+        printf_P(PSTR(SAVE_CURSOR));
+        sendCsi2(this.statusBarRows + 1, terminalRows, 'r');
+        printf_P(PSTR(RESTORE_CURSOR));
+    }
+    this.terminalRows = terminalRows;
+    applyScrollRegion();
+    return 1;
+}
+
+// Clear the screen, the status bar rows are kept in scroll region mode
+void cliClearScreen()
+{
+    if (this.scrollRegion)
+    {
+        sendCsi2(this.statusBarRows + 1, 1, 'H');
+        printf_P(PSTR(CLEAR_TO_SCREEN_END));
+    }
+    else
+        printf_P(PSTR(CLEAR_SCREEN));
+}
+
+// Start counting the lines printed to be overwritten by cliRewindOutput()
+void cliMarkOutput()
+{
+    this.outputLines = 0;
+}
+
+// Move the cursor back to the first line printed since cliMarkOutput() and clear the screen below,
+// so the next output overwrites it in place. Lines are counted again from there
+void cliRewindOutput()
+{
+    txPut('\r');
+    if (this.outputLines)
+        sendCsi(this.outputLines, 'A');
+    txWrite(CLEAR_TO_SCREEN_END, sizeof(CLEAR_TO_SCREEN_END) - 1);
+    // the status bar printed above the prompt is this many lines closer again
+    if (!this.scrollRegion)
+        this.lineFeedCounter -= this.outputLines < this.lineFeedCounter ? this.outputLines : this.lineFeedCounter;
+    this.outputLines = 0;
+}
+
 // Update status bar in terminal
 void cliPrintStatusBar(unsigned char hideCursor)
 {
-    unsigned char lineFeedsTotal = this.lineFeedCounter;
+    unsigned int lineFeedsTotal = this.lineFeedCounter;
+
+    if (this.statusFields != NULL)
+    {
+        // limit the refresh rate and skip status bars printed too far above the prompt
+        if (clockMillis() - this.statusLastUpdate < this.statusInterval)
+            return;
+        this.statusLastUpdate = clockMillis();
+        if (this.scrollRegion)
+            updateStatusFields(0, hideCursor);
+        else if (lineFeedsTotal >= this.statusBarRows && lineFeedsTotal <= CLI_STATUS_BAR_REACH)
+            updateStatusFields((uint8_t) lineFeedsTotal, hideCursor);
+        return;
+    }
+    // a status bar printed too far above the prompt is printed again with the next prompt
+    if (lineFeedsTotal > CLI_STATUS_BAR_REACH)
+        return;
     if (lineFeedsTotal)
     {
         if (hideCursor)
             cliHideCursor();
         // Move cursor numOflineFeeds up and set it to its beginning
-        moveCursorPreviousLine('0' + lineFeedsTotal / 10, '0' + lineFeedsTotal % 10);
+        sendCsi(lineFeedsTotal, 'F');
         // Reset UART.lineFeedCounter to count how many line feeds are printed by cliPrintStatusBarLines and afterwards
         // until cliPrintStatusBar is called again. This way all postPromptLineFeeds can be counted as well
         this.lineFeedCounter = 0;
@@ -441,7 +1189,7 @@ void cliPrintStatusBar(unsigned char hideCursor)
         while (this.lineFeedCounter < lineFeedsTotal)
             printf("\n"); 
         // Move cursor horizontally to where it was before printing the status bar
-        moveCursorForward('0' + ((this.rcvIndex + this.promptLength) / 10), '0' + ((this.rcvIndex + this.promptLength) % 10));
+        sendCsi(this.rcvIndex + this.promptLength + 1, 'G');
         if (hideCursor)
             cliShowCursor();
     }
@@ -463,65 +1211,103 @@ void cliPrintRcvdString()
 // Print ring buffer
 void cliPrintRingBuffer()
 {
-    printf_P(PSTR("Ring buffer\n"));
-    for(int i = 0; i <= REC_CHAR_MAX; i++)
+    printf_P(PSTR("Ring buffer, overruns: %u, framing errors: %u\n"), cliGetRxOverruns(), cliGetRxFrameErrors());
+    for(int i = 0; i < RX_BUF_SIZE; i++)
     {
         if (this.ringBuf[i] == 0x1B)
-            printf_P(PSTR("%02d:0x1B ESC\n"), i);
+            printf_P(PSTR("%03d:0x1B ESC\n"), i);
         else if (this.ringBuf[i] == DELETE)
-            printf_P(PSTR("%02d:0x7F DELETE\n"), i);
+            printf_P(PSTR("%03d:0x7F DELETE\n"), i);
         else if (this.ringBuf[i] == '\n')
-            printf_P(PSTR("%02d:0x0A LINE FEED\n"), i);
+            printf_P(PSTR("%03d:0x0A LINE FEED\n"), i);
         else if (this.ringBuf[i] == '\r')
-            printf_P(PSTR("%02d:0x0D CARRIAGE RETURN\n"), i);            
+            printf_P(PSTR("%03d:0x0D CARRIAGE RETURN\n"), i);            
         else if (this.ringBuf[i] == CTRL_A)
-            printf_P(PSTR("%02d:0x01 Ctrl+A\n"), i);
+            printf_P(PSTR("%03d:0x01 Ctrl+A\n"), i);
         else if (this.ringBuf[i] == CTRL_C)
-            printf_P(PSTR("%02d:0x01 Ctrl+C\n"), i);
+            printf_P(PSTR("%03d:0x01 Ctrl+C\n"), i);
         else if (this.ringBuf[i] == CTRL_D)
-            printf_P(PSTR("%02d:0x01 Ctrl+D\n"), i);
+            printf_P(PSTR("%03d:0x01 Ctrl+D\n"), i);
         else if (this.ringBuf[i] == CTRL_L)
-            printf_P(PSTR("%02d:0x01 Ctrl+L\n"), i);
+            printf_P(PSTR("%03d:0x01 Ctrl+L\n"), i);
         else if (this.ringBuf[i] == CTRL_U)
-            printf_P(PSTR("%02d:0x01 Ctrl+U\n"), i);
+            printf_P(PSTR("%03d:0x01 Ctrl+U\n"), i);
         else if (this.ringBuf[i] == CTRL_X)
-            printf_P(PSTR("%02d:0x01 Ctrl+X\n"), i);
+            printf_P(PSTR("%03d:0x01 Ctrl+X\n"), i);
         else if (this.ringBuf[i] == CTRL_Y)
-            printf_P(PSTR("%02d:0x01 Ctrl+Y\n"), i);
+            printf_P(PSTR("%03d:0x01 Ctrl+Y\n"), i);
         else if (this.ringBuf[i] == CTRL_Z)
-            printf_P(PSTR("%02d:0x01 Ctrl+Z\n"), i);                                                
+            printf_P(PSTR("%03d:0x01 Ctrl+Z\n"), i);                                                
         else
-            printf_P(PSTR("%02d:0x%02X %c\n"), i, this.ringBuf[i], this.ringBuf[i]);
+            printf_P(PSTR("%03d:0x%02X %c\n"), i, this.ringBuf[i], this.ringBuf[i]);
     }  
 }
 
-// Receive serial data dn store it in a ring buffer
+// Get the number of received characters lost due to a full receive ring buffer or an UART data overrun
+unsigned int cliGetRxOverruns()
+{
+    unsigned int rxOverruns;
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+        rxOverruns = this.rxOverruns;
+    return rxOverruns;
+}
+
+// Get the number of received characters discarded due to a framing or parity error
+unsigned int cliGetRxFrameErrors()
+{
+    unsigned int rxFrameErrors;
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+        rxFrameErrors = this.rxFrameErrors;
+    return rxFrameErrors;
+}
+
+// Store a received character in the receive ring buffer of instance
+static void storeByte(struct Cli *instance, char charRcvd)
+{
+    uint16_t head = (instance->rxHead + 1) & RX_MASK;
+    // keep unread characters and count the lost one if the ring buffer is full
+    if (head == instance->rxTail)
+    {
+        instance->rxOverruns++;
+        return;
+    }
+    instance->ringBuf[instance->rxHead] = charRcvd;
+    instance->rxHead = head;
+    eventPost(EVENT_CLI_RX, (uint8_t) charRcvd);
+}
+
+// Receive serial data and store it in the ring buffer of the instance selected, the USART RX Complete ISRs
+// store into the ring buffer of the instance bound to their USART
 void cliReceiveByte(char charRcvd)
 {
-    this.ringBuf[this.ringBufIndex++ & REC_CHAR_MAX] = charRcvd;
-    this.ringBuf[this.ringBufIndex & REC_CHAR_MAX] = '\0';
-} 
+    // called outside the ISRs, which update the same ring buffer and event queue
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+        storeByte(&this, charRcvd);
+}
 
 // Command line interface state machine to be used with a terminal programme
 unsigned char cliProcessRxData()
 {
-    static unsigned int rcvIndex = 0;
-    if (this.ringBuf[rcvIndex & REC_CHAR_MAX] != '\0')
+    uint16_t rxHead;
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+        rxHead = this.rxHead;
+    if (this.rxTail != rxHead)
     { 
-        #ifdef UART_ISR_CHARACTER_ECHOING
-            #ifdef CURSOR_HIDING
-                static unsigned char hideCursorFlag = 0;
-            #endif
-        #endif
         //STEP A - CHARACTER RECEIVING
         // save received character
-        this.rcvChar = this.ringBuf[rcvIndex++ & REC_CHAR_MAX];
+        this.rcvChar = this.ringBuf[this.rxTail];
+        ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+            this.rxTail = (this.rxTail + 1) & RX_MASK;
 
         //change UART.charRcvd to \n in case it is \r
         this.rcvChar = this.rcvChar != '\r' ? this.rcvChar : '\n';
         
         #ifdef UART_ISR_CHARACTER_ECHOING
 
+        // any character interrupts CLI_BINARY_MAGIC unless matchBinaryMagic() continues the match
+        uint8_t magicMatched = this.magicMatched;
+        this.magicMatched = 0;
+
         // check supported CTRL-characters
         if(this.rcvChar < ESCAPE)
         {
@@ -537,8 +1323,9 @@ unsigned char cliProcessRxData()
                     {
                         // handle Ctrl-key to run trigger command execution and stop receiving
                         this.ctrlKey = this.rcvChar;
+                        this.argc = 0;
                         this.lineFeedCounter++;
-                        UDR0 = '\n';
+                        sendWhenReady('\n');
                     }
                     return 1;
                 }
@@ -547,7 +1334,10 @@ unsigned char cliProcessRxData()
         // Suppress any non-printable character except the new line character
         // by ending the if-else-if structure here, so no further code is being executed in the ISR
         if(this.rcvChar != '\n' && this.rcvChar != ESCAPE && this.rcvChar <= 0x1F)
+        {
+            matchBinaryMagic(magicMatched);
             return 0;
+        }
 
         //STEP B - HANDLING DELETE-KEY
         // character deletion on backspace key
@@ -558,7 +1348,7 @@ unsigned char cliProcessRxData()
             {
                 // delete last character in command line by moving back
                 // the cursor to overwrite existing terminal character(s)
-                UDR0 = BACKSPACE;
+                sendWhenReady(BACKSPACE);
                 // delete last character in UART.rcvBuf
                 if (this.rcvIndex == this.rcvIndexMax)
                 {
@@ -574,19 +1364,16 @@ unsigned char cliProcessRxData()
                     if (!this.pCtrlKey)
                     {    //hideCursor(hideCursorFlag);
                         cliHideCursor();
-                        hideCursorFlag = 1;
+                        this.hideCursorFlag = 1;
                     }
                     #endif
                     // go back to the position of the character to be deleted and copy
                     // all following characters one position to the left
                     for (uint8_t i = --this.rcvIndex; i < this.rcvIndexMax; i++)
-                        sendWhenReady(this.rcvBuf[i] = this.rcvBuf[i + 1]);
+                        this.rcvBuf[i] = this.rcvBuf[i + 1];
                     this.rcvIndexMax--;
-                    // overwrite last character in command line with a space character
-                    sendWhenReady(' ');
-                    // set back cursor in command line where it was before overwritting characters
-                    for (uint8_t i = this.rcvIndex; i < this.rcvIndexMax + 1; i++)
-                        setCursorLeft();
+                    // rewrite the rest of the command line and set back the cursor in one go
+                    rewriteAfterDeletion();
                 }
             }
         }
@@ -616,77 +1403,41 @@ unsigned char cliProcessRxData()
                             {
                                 //hideCursor(hideCursorFlag);
                                 cliHideCursor();
-                                hideCursorFlag = 1;
+                                this.hideCursorFlag = 1;
                             }
                         #endif
 
-                        // overwrite current command line with space characters on UP- and DOWN Arrow-Key
-                        if (this.rcvChar == UP_ARROW_KEY || this.rcvChar == DOWN_ARROW_KEY)
-                        {
-                            if(this.rcvIndexMax)
-                            {                        
-                                // move cursor to the very left input position
-                                while(this.rcvIndex)
-                                {
-                                    setCursorLeft();
-                                    this.rcvIndex--;
-                                }
-
-                                // delete all input characters shown in terminal
-                                clearUserInput();
-
-                                // overwrite all characters stored in UART.rcvBuf
-                                while (this.rcvIndex < this.rcvIndexMax)
-                                    this.rcvBuf[this.rcvIndex++] = '\0';
-
-                                // restore empty buffer variable states
-                                this.rcvIndex = 0;
-                                this.rcvIndexMax = 0;
-
-                                // reset UART.lastCommandIndex to last entered command
-                                if (this.rcvChar == DOWN_ARROW_KEY)
-                                    this.lastCmdIndex = this.histIndex + 1 > SIZE - 1 ? this.histIndex + 1 - (SIZE) : this.histIndex + 1;
-                            }
-                        }
-                        // restore previous command line entered to the console on "arrow up" = 0x41
+                        // replace the command line by an older or newer command of the history
                         if (this.rcvChar == UP_ARROW_KEY)
-                        {
-                            int8_t histIndex = this.lastCmdIndex;
-                            int8_t counter = 0;           
-                            while(this.histBuf[histIndex] != 0x0A && counter++ <= SIZE)
-                            {
-                                if(this.histBuf[histIndex] != 0x00)
-                                {
-                                    this.rcvBuf[this.rcvIndex++] = this.histBuf[histIndex];
-                                    sendWhenReady(this.histBuf[histIndex]);
-                                    this.rcvIndexMax++;
-                                }
-                                histIndex = ++histIndex > SIZE - 1 ? histIndex - (SIZE) : histIndex;
-                            }
-                            this.lastCmdIndex = ++histIndex > SIZE - 1 ? histIndex - (SIZE) : histIndex;                        
-                        }
+                            recallHistory(1);
+                        if (this.rcvChar == DOWN_ARROW_KEY)
+                            recallHistory(-1);
                         // echo RIGHT-Arrow-Key
                         if (this.rcvChar == RIGHT_ARROW_KEY)
                             if (this.rcvBuf[this.rcvIndex] != '\0')
-                                setCursorRight(this.rcvIndex++);
+                            {
+                                moveCursor(1);
+                                this.rcvIndex++;
+                            }
                         // echo LEFT-Arrow-Key
                         if (this.rcvChar == LEFT_ARROW_KEY)
                             if (this.rcvIndex)
-                                setCursorLeft(this.rcvIndex--);
-                        // handle END-Key for Serial Monitor in VSC
-                        if(this.escSeqState == END)
-                            while(this.rcvIndex < this.rcvIndexMax)
                             {
-                                setCursorRight();
-                                this.rcvIndex++;
+                                moveCursor(-1);
+                                this.rcvIndex--;
                             }
+                        // handle END-Key for Serial Monitor in VSC
+                        if(this.escSeqState == END)
+                        {
+                            moveCursor(this.rcvIndexMax - this.rcvIndex);
+                            this.rcvIndex = this.rcvIndexMax;
+                        }
                         // handle POS1-Key for Serial Monitor in VSC
                         if(this.rcvChar == POS1)
-                            while(this.rcvIndex)
-                            {
-                                setCursorLeft();
-                                this.rcvIndex--;
-                            }
+                        {
+                            moveCursor(-this.rcvIndex);
+                            this.rcvIndex = 0;
+                        }
                     }
                 }
             }
@@ -736,34 +1487,33 @@ unsigned char cliProcessRxData()
                     {
                         //hideCursor(hideCursorFlag);
                         cliHideCursor();
-                        hideCursorFlag = 1;
+                        this.hideCursorFlag = 1;
                     }
                     #endif
 
                     // handle POS1-Key
                     if(this.escSeqState == POS1_ISO8850)
-                        while(this.rcvIndex)
-                            setCursorLeft(this.rcvIndex--);
+                    {
+                        moveCursor(-this.rcvIndex);
+                        this.rcvIndex = 0;
+                    }
                     // handle DEL-Key
                     if(this.escSeqState == DEL)
                     {
                         if (this.rcvIndex < this.rcvIndexMax && this.rcvChar != '\n')
                         {
                             for (int8_t i = this.rcvIndex; i < this.rcvIndexMax; i++)
-                                sendWhenReady(this.rcvBuf[i] = this.rcvBuf[i + 1]);
-                            sendWhenReady(' ');
+                                this.rcvBuf[i] = this.rcvBuf[i + 1];
                             this.rcvIndexMax--;
-                            for (int8_t i = this.rcvIndex; i <= this.rcvIndexMax; i++)
-                                setCursorLeft();
+                            rewriteAfterDeletion();
                         }
                     }
                     // handle END-Key
                     else if(this.escSeqState == END_ISO8850)
-                        while(this.rcvIndex < this.rcvIndexMax)
-                        {
-                            setCursorRight();
-                            this.rcvIndex++;
-                        }
+                    {
+                        moveCursor(this.rcvIndexMax - this.rcvIndex);
+                        this.rcvIndex = this.rcvIndexMax;
+                    }
                 }
             }
         }
@@ -781,7 +1531,7 @@ unsigned char cliProcessRxData()
             }
             // password masking
             if (this.pwdChar != '\0' && this.rcvChar != '\n')
-                UDR0 = this.pwdChar;
+                sendWhenReady(this.pwdChar);
             // echo every character to sender
             else
             {
@@ -790,7 +1540,7 @@ unsigned char cliProcessRxData()
                     cliHideCursor();
                     this.lineFeedCounter++;
                 }
-                UDR0 = this.rcvChar;
+                sendWhenReady(this.rcvChar);
             }
             // store command line end character after all received characters in UART.rcvBuf
             if (this.rcvChar == '\n')
@@ -805,16 +1555,14 @@ unsigned char cliProcessRxData()
                     {
                         //hideCursor(hideCursorFlag);
                         cliHideCursor();
-                        hideCursorFlag = 1;
+                        this.hideCursorFlag = 1;
                     }
                     #endif
 
                     // rewrite all characters to the right of the inserted character
-                    for (int8_t i = this.rcvIndex + 1; i <= this.rcvIndexMax; i++)
-                        sendWhenReady(this.rcvBuf[i]);
-                    // set cursor left again to position it where it was before
-                    for (int8_t i = this.rcvIndex + 1; i < this.rcvIndexMax; i++)
-                        setCursorLeft();
+                    // and set cursor left again to position it where it was before
+                    txWrite(this.rcvBuf + this.rcvIndex + 1, this.rcvIndexMax - this.rcvIndex - 1);
+                    moveCursor(-(this.rcvIndexMax - this.rcvIndex - 1));
                     this.rcvBuf[this.rcvIndex++] = this.rcvChar;
                 }
                 else
@@ -831,7 +1579,7 @@ unsigned char cliProcessRxData()
         else if (this.rcvChar == '\n' && !this.pCtrlKey)
         {
             cliHideCursor();
-            UDR0 = '\n';
+            sendWhenReady('\n');
             this.lineFeedCounter++;
             this.rcvBuf[SIZE - 1] = '\n';
         }
@@ -840,61 +1588,22 @@ unsigned char cliProcessRxData()
         // disable receive interrupt after receiving '\n'
         if (this.rcvChar == '\n' && !this.pCtrlKey)
         {
-            int searchResult = 0;
-            int compareIndex, index = 0;        
-            if(this.rcvIndex != 0)
-            {
-                // compare current command only with last added command in histBuf
-                compareIndex = this.histIndex + 1 > SIZE - 1 ? this.histIndex + 1 - (SIZE) : this.histIndex + 1;
-                if (this.histBuf[compareIndex] == this.rcvBuf[0])
-                {
-                    do
-                    {
-                        index++;
-                        compareIndex = compareIndex + index > SIZE - 1 ? compareIndex - (SIZE) : compareIndex;
-                    } while (index <= this.rcvIndex && this.histBuf[compareIndex + index] == this.rcvBuf[index]);
-                    if (index == this.rcvIndex + 1)
-                        searchResult = 1;
-                }
-
-                this.lastCmdIndex = this.histIndex + 1 > SIZE - 1 ? this.histIndex + 1 - (SIZE) : this.histIndex + 1;
-                if (searchResult == 0)
-                {
-                    // copy the received string into UART.histBuf, if no pwdChar is set
-                    if (this.pwdChar == '\0' && this.rcvIndexMax >= 1)           //UART.rvcIndexMax > 1
-                    {         
-                        for (int8_t counter = 0; counter <= this.rcvIndexMax; counter++)
-                        {
-                            this.histBuf[this.histIndex--] = this.rcvBuf[this.rcvIndexMax - counter];
-                            this.histIndex = this.histIndex < 0 ? this.histIndex + SIZE : this.histIndex;
-                        }
-                        this.histIndex = this.histIndex < 0 ? this.histIndex + SIZE : this.histIndex;
-
-                        // delete partly overwritten commands in UART.histBuf
-                        if (this.histBuf[this.histIndex] != 0x00 && this.histBuf[this.histIndex] != 0x0A)
-                        {
-                            int index = this.histIndex;
-                            for(int8_t counter = 0; this.histBuf[index] != 0x0A && counter < SIZE; counter++)
-                            {
-                                this.histBuf[index--] = 0x00;
-                                index = index < 0 ? index + SIZE : index;        
-                            }
-                        }
-                        // set index for last added command
-                        this.lastCmdIndex = this.histIndex + 1 > SIZE - 1 ? this.histIndex + 1 - (SIZE) : this.histIndex + 1;
-                    }
-                }
-            }
-            UCSR0B &= ~(1 << RXEN0); // disable the UART receiver
+            // copy the received command line into the history, if no pwdChar is set
+            if (this.pwdChar == '\0')
+                cliAddHistoryEntry(this.rcvBuf, this.rcvIndexMax);
+            // split the command line into tokens once for all following cliGetArgv() calls
+            tokenize();
+            // keep the UART receiver enabled: characters received during command
+            // execution are buffered in the ring buffer and processed afterwards
             return 1;
         }
 
         #ifdef CURSOR_HIDING
-        if (hideCursorFlag == 1)
+        if (this.hideCursorFlag == 1)
         {
             //showCursor(hideCursorFlag);
             cliShowCursor();
-            hideCursorFlag = 0;
+            this.hideCursorFlag = 0;
         }
         #endif
 
@@ -916,4 +1625,91 @@ unsigned char cliProcessRxData()
         #endif //UART_ISR_CHARACTER_ECHOING
     }
     return 0;
-}
\ No newline at end of file
+}
+
+// RX Complete interrupt of the USART bound to instance: store the received character in its receive ring buffer
+static void receiveComplete(struct Cli *instance)
+{
+    // UCSRnA has to be read before UDRn
+    uint8_t status = usartA(*instance);
+    char charRcvd = usartData(*instance);
+    if (status & (1 << DOR0))
+        instance->rxOverruns++;
+    if (status & ((1 << FE0) | (1 << UPE0)))
+        instance->rxFrameErrors++;
+    else
+        storeByte(instance, charRcvd);
+}
+
+// Data Register Empty interrupt of the USART bound to instance: hand over the next character of its
+// transmit ring buffer
+static void dataRegisterEmpty(struct Cli *instance)
+{
+    if (instance->txTail != instance->txHead)
+    {
+        usartData(*instance) = instance->txBuf[instance->txTail];
+        instance->txTail = (instance->txTail + 1) & TX_MASK;
+    }
+    // disable the interrupt as soon as the ring buffer is empty
+    if (instance->txTail == instance->txHead)
+        usartB(*instance) &= ~(1 << UDRIE0);
+}
+
+#if CLI_USARTS > 1
+
+// USART RX Complete and Data Register Empty ISRs, enabled only for the USARTs bound by cliInitInstance()
+ISR(USART0_RX_vect)
+{
+    receiveComplete(usartInstances[0]);
+}
+
+ISR(USART0_UDRE_vect)
+{
+    dataRegisterEmpty(usartInstances[0]);
+}
+
+ISR(USART1_RX_vect)
+{
+    receiveComplete(usartInstances[1]);
+}
+
+ISR(USART1_UDRE_vect)
+{
+    dataRegisterEmpty(usartInstances[1]);
+}
+
+ISR(USART2_RX_vect)
+{
+    receiveComplete(usartInstances[2]);
+}
+
+ISR(USART2_UDRE_vect)
+{
+    dataRegisterEmpty(usartInstances[2]);
+}
+
+ISR(USART3_RX_vect)
+{
+    receiveComplete(usartInstances[3]);
+}
+
+ISR(USART3_UDRE_vect)
+{
+    dataRegisterEmpty(usartInstances[3]);
+}
+
+#else
+
+// UART RX Complete ISR: store the received character in the receive ring buffer
+ISR(USART_RX_vect)
+{
+    receiveComplete(&instances[0]);
+}
+
+// UART Data Register Empty ISR: hand over the next character of the transmit ring buffer
+ISR(USART_UDRE_vect)
+{
+    dataRegisterEmpty(&instances[0]);
+}
+
+#endif
\ No newline at end of file
@@ -0,0 +1,144 @@
+/*
+ * File:            clock.c
+ * Author:          Thomas Jerman
+ * Date Created:    18.10.2026
+ *
+ * Description:
+ * Providing a monotonic clock based on the 125 us frames of Timer2 and the TCNT2 fraction
+ */
+
+#include <stdio.h>
+
+#include <avr/io.h>
+#include <util/atomic.h>
+
+#include "clock.h"
+
+/****************************************************/
+// LOCAL DEFINES
+/****************************************************/
+
+/****************************************************/
+// LOCAL STRUCT DEFINITION
+/****************************************************/
+
+// Declaration of the clock struct, written by clockTick() only
+struct Clock
+{
+    volatile uint32_t millis;           // milliseconds, low 32 bits
+    volatile uint16_t millisHigh;       // milliseconds, bits 32 to 47
+    volatile uint8_t frame;             // frames of the current millisecond
+};
+
+// Snapshot of the clock taken with interrupts disabled
+struct ClockSnapshot
+{
+    uint32_t millis;
+    uint16_t millisHigh;
+    uint16_t micros;                    // microseconds of the current millisecond
+};
+
+/****************************************************/
+// LOCAL STATIC STRUCT VARIABLE DECLARATION, INIT
+/****************************************************/
+
+static struct Clock this;
+
+/****************************************************/
+// LOCAL MACROS
+/****************************************************/
+
+/****************************************************/
+// LOCAL FUNCTIONS
+/****************************************************/
+
+// Take a snapshot of the clock including the TCNT2 fraction (0.5 us per count) of the current frame
+static void getSnapshot(struct ClockSnapshot *snapshot)
+{
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+    {
+        uint8_t count = TCNT2;
+        uint8_t frame = this.frame;
+        snapshot->millis = this.millis;
+        snapshot->millisHigh = this.millisHigh;
+        // compare match not yet handled by the ISR: TCNT2 restarted from 0 within the next frame
+        if ((TIFR2 & (1 << OCF2A)) && count < (OCR2A >> 1))
+        {
+            if (++frame == CLOCK_FRAMES_PER_MS)
+            {
+                frame = 0;
+                if (++snapshot->millis == 0)
+                    snapshot->millisHigh++;
+            }
+        }
+        snapshot->micros = frame * CLOCK_US_PER_FRAME + (count >> 1);
+    }
+}
+
+/****************************************************/
+// GLOBAL FUNCTIONS
+/****************************************************/
+
+// Advance the clock by one frame, called by ISR(TIMER2_COMPA_vect) only
+void clockTick()
+{
+    if (++this.frame == CLOCK_FRAMES_PER_MS)
+    {
+        this.frame = 0;
+        if (++this.millis == 0)
+            this.millisHigh++;
+    }
+}
+
+// Get the milliseconds since timer2CTCInit(), wraps after 49.7 days
+uint32_t clockMillis()
+{
+    uint32_t millis;
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+        millis = this.millis;
+    return millis;
+}
+
+// Get the microseconds since timer2CTCInit() with a resolution of 1 us, wraps after 71.6 minutes
+uint32_t clockMicros()
+{
+    struct ClockSnapshot snapshot;
+    getSnapshot(&snapshot);
+    return snapshot.millis * 1000UL + snapshot.micros;
+}
+
+// Get the microseconds since timer2CTCInit() without wrapping
+uint64_t clockUptimeMicros()
+{
+    struct ClockSnapshot snapshot;
+    getSnapshot(&snapshot);
+    return (((uint64_t) snapshot.millisHigh << 32) | snapshot.millis) * 1000 + snapshot.micros;
+}
+
+// Get the deadline timeout milliseconds from now, check it with clockExpiredMillis()
+uint32_t clockDeadlineMillis(uint32_t timeout)
+{
+    return clockMillis() + timeout;
+}
+
+// Check a deadline of clockDeadlineMillis(), valid for timeouts up to 24.8 days
+// Return value:    1: deadline passed
+//                  0: deadline ahead
+uint8_t clockExpiredMillis(uint32_t deadline)
+{
+    return (int32_t) (clockMillis() - deadline) >= 0;
+}
+
+// Get the deadline timeout microseconds from now, check it with clockExpiredMicros()
+uint32_t clockDeadlineMicros(uint32_t timeout)
+{
+    return clockMicros() + timeout;
+}
+
+// Check a deadline of clockDeadlineMicros(), valid for timeouts up to 35.8 minutes
+// Return value:    1: deadline passed
+//                  0: deadline ahead
+uint8_t clockExpiredMicros(uint32_t deadline)
+{
+    return (int32_t) (clockMicros() - deadline) >= 0;
+}
@@ -17,399 +17,905 @@
 #include <avr/interrupt.h>
 #include <avr/pgmspace.h>
 #include <avr/wdt.h>
+#include <util/atomic.h>
 #include <util/delay.h>
 
 #include "sfr328p.h"
 #include "cli.h"
 #include "cmd.h"
-#include "timer1.h"
+#include "config.h"
+#include "eeq.h"
+#include "hal.h"
+#include "history.h"
+#include "journal.h"
+#include "out.h"
+#include "proto.h"
+#include "sched.h"
 #include "timer2.h"
 
 /****************************************************/
 // LOCAL DEFINES
 /****************************************************/
 
+#define DEFAULT_COMMANDS_COUNT  (sizeof(defaultCommands) / sizeof(defaultCommands[0]))
+#define WATCH_PERIOD_MAX        (0xFFFF / SCHED_FRAMES_PER_MS)  // longest watch period in ms
+
+// Keywords of cle, positions returned by cmdGetArgKeyword()
+#define CLE_KEYWORDS            "all var sfr"
+#define CLE_ALL                 1
+#define CLE_VAR                 2
+#define CLE_SFR                 3
+
 /****************************************************/
 // LOCAL STRUCT DEFINITION
 /****************************************************/
 
+// Declaration of the pending command struct, one per CLI instance
+struct Cmd
+{
+    CmdStep step;                       // step of the pending command, NULL if no command is pending
+    CmdHandler cancel;                  // called instead of step on Ctrl+C, may be NULL
+    struct CmdThread thread;            // resume point of step
+    uint8_t lineReceived;               // 1 while step is called with a received command line
+    char ctrlKey;                       // CTRL-key received while the pending command ignores input
+    uint8_t echoPassword;               // 1 to echo the password as '*' characters
+    CmdHandler watchHandler;            // command bound by watch, its parameters stay in the CLI argument vector
+    uint8_t watchTask;                  // scheduler task flagging the runs of watch, SCHED_INVALID_TASK if not added yet
+    volatile uint8_t watchDue;          // 1 if the watched command is due
+    uint16_t argValues[CMD_ARGS_MAX];   // parameters converted by cmdBindCommand()
+    uint8_t argKeywords[CMD_ARGS_MAX];  // keyword positions of the parameters, 0 if no keyword was given
+};
+
 /****************************************************/
 // LOCAL STATIC STRUCT VARIABLE DECLARATION, INIT
 /****************************************************/
 
+static struct Cmd instances[CLI_INSTANCES] =
+{
+    [0 ... CLI_INSTANCES - 1] = {.watchTask = SCHED_INVALID_TASK}
+};
+
+// Application command table set by cmdSetApplicationCommands()
+static const struct CmdEntry *applicationCommands = NULL;
+static uint8_t applicationCommandsCount = 0;
+
 /****************************************************/
 // LOCAL MACROS
 /****************************************************/
 
+// Commands run on the CLI instance selected, a single instance is addressed directly
+#if CLI_INSTANCES > 1
+#define this                    instances[cliGetInstance()]
+#else
+#define this                    instances[0]
+#endif
+
 /****************************************************/
 // LOCAL FUNCTIONS
 /****************************************************/
 
-/****************************************************/
-// GLOBAL FUNCTIONS
-/****************************************************/
+// ac = application commands
+static void executeAc(uint8_t *login_status)
+{
+    cmdShowApplicationCommands();
+}
 
-// Executes all commands defined
-uint8_t cmdExecuteCommand(uint8_t *login_status)
+// cd = command details [-/0/1]
+static void executeCd(uint8_t *login_status)
 {
-    char *cmd = NULL, *param = NULL;
-    char charCtrlKey;
+    printf_P(PSTR("Command details"));
+    cmdSetFlag(CFG_COMMAND_DETAILS);
+}
 
-    // add EEPROM variables on top of the already defined ones to get the next
-    // valid address. This avoids address rearrangement of all predefined eeprom variables
-    // static uint8_t EEMEM nextVariable;       //address = 0x04
-    static uint8_t EEMEM statusBarFlag;         //address = 0x03
-    static uint8_t EEMEM commandDetailsFlag;    //address = 0x02
-    static uint8_t EEMEM commandHistoryFlag;    //address = 0x01
-    static uint8_t EEMEM echoAllCommandsFlag;   //address = 0x00
+// ce = command echo [0/1]
+static void executeCe(uint8_t *login_status)
+{
+    printf_P(PSTR("Command echo"));
+    cmdSetFlag(CFG_ECHO_ALL_COMMANDS);
+}
 
-    // Hand over statusBarFlag from EEPROM to cliSetStatusBarFlag
-    cliSetStatusBarFlag(eeprom_read_byte(&statusBarFlag));
+#ifdef UART_ISR_CHARACTER_ECHOING
+// ch = command history [-/0/1]
+static void executeCh(uint8_t *login_status)
+{
+    printf_P(PSTR("Command history"));
+    cmdSetFlag(CFG_COMMAND_HISTORY);
+}
+#endif
 
-    // Echo all commands if not in terminal mode in VSC and UART_ISR_CHARACTER_ECHOING is not defined
-    if (eeprom_read_byte(&echoAllCommandsFlag) == 1)
-        cliPrintRcvdString();   
-    
-    // Print received command and parameters, returns num_of_params
-    if (eeprom_read_byte(&commandDetailsFlag) == 1)
-        cliPrintCmdDetails();
+// Format the journal and reset the configuration to its defaults once the EEPROM is cleared,
+// EVENT_EEPROM wakes the main loop as soon as the queue has drained
+static uint8_t stepCleAll(struct CmdThread *thread, uint8_t *login_status)
+{
+    CMD_BEGIN(thread);
+    CMD_WAIT_UNTIL(thread, eeqIsIdle());
+    journalInit();
+    cfgInit();
+    printf_P(PSTR("Clearing EEPROM: done\n"));
+    CMD_END(thread);
+}
 
-    // Check for received CTRL-Keys
-    if ((charCtrlKey = cliGetCtrlKey()) != 0)
+// Queued EEPROM writes cannot be cancelled, wait for them to keep the journal consistent
+static void cancelCleAll(uint8_t *login_status)
+{
+    eeqFlush();
+    journalInit();
+    cfgInit();
+    printf_P(PSTR("Clearing EEPROM: done, queued writes cannot be cancelled\n"));
+}
+
+// cle = clear EEPROM [all/sfr/var]
+static void executeCle(uint8_t *login_status)
+{
+    switch (cmdGetArgKeyword(1))
     {
-        switch (charCtrlKey)
-        {
-            case CTRL_A:    cmdShowApplicationCommands();
-                            break;
+        // clearing EEPROM at all addresses in the background, unchanged bytes are skipped,
+        // the journal writes nothing into the range being cleared until stepCleAll() formats it
+        case CLE_ALL:
+            if (eeqFill(0, EEPROM_ADDRESS_LIMIT + 1, 0xFF))
+            {
+                journalSuspend();
+                printf_P(PSTR("Clearing EEPROM at address range [0x000, 0x%03X]: queued, %u bytes pending\n"),
+                    EEPROM_ADDRESS_LIMIT, eeqGetPending());
+                cmdResume(stepCleAll, cancelCleAll);
+            }
+            else
+                printf_P(PSTR("EEPROM write queue full, try again\n"));
+        break;
 
-            case CTRL_D:    cmdShowDefaultCommands(*login_status);
-                            break;
+        // clearing variables stored in the journal and resetting them to their defaults
+        case CLE_VAR:
+            journalErase(JOURNAL_TYPE_SETTING);
+            cfgInit();
+            printf_P(PSTR("Clearing variables: done\n"));
+        break;
 
-            case CTRL_L:    printf_P(PSTR(CLEAR_SCREEN));
-                            break;
+        // clearing SFR-values stored in the journal
+        case CLE_SFR:
+            journalErase(JOURNAL_TYPE_SFR);
+            printf_P(PSTR("Clearing SFR-values: done\n"));
+        break;
 
-            case CTRL_U:    cmdSwitchUser(login_status, echoAllCommandsFlag);
-                            break;
+        default:
+            printf_P(PSTR("Clear EEPROM\n"));
+            printf_P(PSTR("Clearing EEPROM at all addresses:      \"cle all\", address range: [0x000, 0x%03X]\n"), EEPROM_ADDRESS_LIMIT);
+            printf_P(PSTR("Clearing Variables written to EEPROM:  \"cle var\", journal entries of type setting\n"));
+            printf_P(PSTR("Clearing SFR-values written to EEPROM: \"cle sfr\", journal entries of type SFR\n"));
+            printf_P(PSTR("EEPROM journal: generation %u, %u entries, %u free records\n"),
+                journalGetGeneration(), journalGetCount(), journalGetFree());
+        break;
+    }
+}
 
-            case CTRL_Y:    if(*login_status)
-                                cliPrintRingBuffer();
+// clh = clear History
+static void executeClh(uint8_t *login_status)
+{
+    cliClearCmdHistory();
+    printf_P(PSTR("Clearing history: done\n"));
+}
 
-            default:        if(!*login_status)
-                                printf_P(PSTR("Ctrl+%c not assigned\n"), 'A' + charCtrlKey - 1);
-        }
-    }
+// cls = clear Screen
+static void executeCls(uint8_t *login_status)
+{
+    cliClearScreen();
+}
 
-    // cliGetFirstToken() returns the first space separated string received, which is defined to be the command
-    // for command comparison the command cstring pointer is stored in cmd
-    else if ((cmd = cliGetFirstToken()) == NULL)
-    {
-        if (eeprom_read_byte(&commandHistoryFlag) == 1)
-            cliPrintCmdHistory();
-        return 1;
-    }
-   
-    /*******************************************/
-    // START OF DEFAULT COMMAND SECTION
-    /*******************************************/ 
+// dc = default commands
+static void executeDc(uint8_t *login_status)
+{
+    cmdShowDefaultCommands(*login_status);
+}
 
-    // ac = application commands
-    else if (strcmp(cmd, "ac") == 0)
-    {
-        cmdShowApplicationCommands();
-    }   
+// eep = eeprom access [ADDR/all] [-/VAL]
+static void executeEep(uint8_t *login_status)
+{
+    uint16_t address = cmdGetArgValue(1);
+    uint8_t value = cmdGetArgValue(2);
+    uint8_t reading;
 
-    // cd = command details [-/0/1]
-    else if (strcmp(cmd, "cd") == 0)
+    if (cliGetArgc() < 2)
     {
-        printf_P(PSTR("Command details"));
-        cmdSetFlag(&commandDetailsFlag);
+        printf_P(PSTR("EEPROM access\n"));
+        printf_P(PSTR("Reading all values written to EEPROM:  \"eep all\"\n"));
+        printf_P(PSTR("Reading a single value from EEPROM:    \"eep [ADDR]\", address range: [0x0, 0x%03X]\n"), EEPROM_ADDRESS_LIMIT);
+        printf_P(PSTR("Writing a single value to EEPROM:      \"eep [ADDR] [VAL]\", value range: [0x0, 0xFF]\n"));
+        return;
     }
 
-    // clh = clear History
-    else if (strcmp(cmd, "clh") == 0)
+    // eep all
+    if (cmdGetArgKeyword(1))
     {
-        cliClearCmdHistory();
-        printf_P(PSTR("Clearing history: done\n"));
+        for (address = 0; address <= EEPROM_ADDRESS_LIMIT; address++)
+        {
+            value = eeqReadByte(address);
+            if (value != 0xFF)
+            {
+                printf_P(PSTR("EEPROM value at address 0x%03X: 0x%02X\n"), address, value);
+                // result of the binary protocol: address, low byte first, and value of each value written
+                protoPutResult(&address, 2);
+                protoPutResult(&value, 1);
+            }
+        }
+        printf_P(PSTR("Reading all written EEPROM values: done\n"));
+        return;
     }
 
-    // cls = clear Screen
-    else if (strcmp(cmd, "cls") == 0)
+    reading = eeqReadByte(address);
+    printf_P(PSTR("EEPROM reading at address 0x%03X: 0x%02X\n"), address, reading);
+    protoPutResult(&reading, 1);
+    if (cliGetArgc() > 2)
     {
-        printf_P(PSTR(CLEAR_SCREEN));
+        printf_P(PSTR("EEPROM writing at address 0x%03X: 0x%02X\n"), address, value);
+        if (!eeqWriteByte(address, value))
+            printf_P(PSTR("EEPROM write queue full, try again\n"));
     }
+}
 
-    // dc = default commands
-    else if (strcmp(cmd, "dc") == 0)
-    {
-        cmdShowDefaultCommands(*login_status);
-    } 
+// rb = ring buffer (holds the last command line inputs)
+static void executeRb(uint8_t *login_status)
+{
+    cliPrintRingBuffer();
+}
+
+// rst = reset
+static void executeRst(uint8_t *login_status)
+{
+    cfgSave(); // Write back pending configuration changes and queued EEPROM writes before resetting
+    histSave(); // Write back the newest commands of the history before resetting
+    printf_P(PSTR(RESET_SCROLL_REGION CLEAR_SCREEN SHOW_CURSOR));
+    cliFlushTx(); // Send all buffered characters before resetting
+    wdt_enable(WDTO_15MS); // Enable the WDT and set its timeout to 15ms
+    while(1); // Wait for the WDT to reset the microcontroller
+}
+
+// sb = status bar [0/1] [-/ROWS]
+static void executeSb(uint8_t *login_status)
+{
+    uint8_t rows = cmdGetArgValue(2);
 
-    // ce = command echo [0/1]
-    else if (strcmp(cmd, "ce") == 0)
+    printf_P(PSTR("Status bar"));
+    cmdSetFlag(CFG_STATUS_BAR);
+    // Terminal rows reserve the status bar rows using a scroll region, 0 prints the status bar above each prompt
+    if (cliGetArgc() > 2)
     {
-        printf_P(PSTR("Command echo"));
-        cmdSetFlag(&echoAllCommandsFlag);
+        if (!cliSetStatusScrollRegion(rows))
+            printf_P(PSTR("Invalid number of terminal rows: %u\n"), rows);
+        else if (!cfgSet(CFG_STATUS_ROWS, rows))
+            printf_P(PSTR("Terminal rows not saved to EEPROM: journal full\n"));
     }
+    if (cfgGet(CFG_STATUS_ROWS))
+        printf_P(PSTR("Scroll region: %u terminal rows\n"), cfgGet(CFG_STATUS_ROWS));
+    // only the console, CLI instance 0, shows the status bar
+    if (cliGetInstance() == 0)
+        cliSetStatusBarFlag(cfgGet(CFG_STATUS_BAR));
+}
 
-    #ifdef UART_ISR_CHARACTER_ECHOING
-    // ch = command history [-/0/1]    
-    else if (strcmp(cmd, "ch") == 0)
+// sfr = special function register access [ADDR] [-/VAL] [-/wte]
+static void executeSfr(uint8_t *login_status)
+{
+    uint8_t address = cmdGetArgValue(1);
+    uint16_t value = cmdGetArgValue(2);
+    uint8_t intFlag = (address >= 0x84 && address <= 0x8A) || address == 0xC4;
+    uint8_t result = JOURNAL_OK;
+    uint16_t reading;
+
+    if (cliGetArgc() < 2)
     {
-        printf_P(PSTR("Command history"));
-        cmdSetFlag(&commandHistoryFlag);
+        printf_P(PSTR("Special function register access\n"));
+        printf_P(PSTR("Reading a Special Function Register:   \"sfr [ADDR]\", address range: [0x0, 0xFF]\n"));
+        printf_P(PSTR("Writing a Special Function Register:   \"sfr [ADDR] [VAL]\", value range: [0x0, 0xFFFF]\n"));
+        printf_P(PSTR("Writing the SFR-value also to EEPROM:  \"sfr [ADDR] [VAL] wte\", stored in the EEPROM journal\n"));
+        return;
     }
-    #endif
 
-    // sb = status bar
-    else if (strcmp(cmd, "sb") == 0)
+    printf_P(PSTR("SFR reading at address 0x%02X: "), address);
+    reading = intFlag ? cmdRead16BitRegister(address) : cmdRead8BitRegister(address);
+    printf_P(PSTR("0x%02X\n"), reading);
+    // result of the binary protocol: the value read, low byte first
+    protoPutResult(&reading, intFlag ? 2 : 1);
+    if (cliGetArgc() < 3)
+        return;
+
+    printf_P(PSTR("SFR writing at address 0x%02X: "), address);
+    if (intFlag)
+    {
+        printf_P(PSTR("0x%04X "), value);
+        cliFlushTx();
+        cmdWrite16BitRegister(address, value);
+    }
+    else
     {
-        printf_P(PSTR("Status bar"));
-        cmdSetFlag(&statusBarFlag);
-        cliSetStatusBarFlag(eeprom_read_byte(&statusBarFlag));
+        printf_P(PSTR("0x%02X "), (uint8_t) value);
+        cliFlushTx();
+        cmdWrite8BitRegister(address, (uint8_t) value);
     }
 
-    // su = switch user
-    else if (strcmp(cmd, "su") == 0)
+    // sfr ADDR VAL wte
+    if (cmdGetArgKeyword(3))
     {
-        cmdSwitchUser(login_status, echoAllCommandsFlag);
-    }    
+        printf_P(PSTR("writing to EEPROM journal"));
+        if (intFlag)
+            result = journalWrite(JOURNAL_TYPE_SFR16, address, value);
+        else
+            result = journalWrite(JOURNAL_TYPE_SFR, address, (uint8_t) value);
+        if (result == JOURNAL_BUSY)
+            printf_P(PSTR(" failed, EEPROM write queue full"));
+        else if (result == JOURNAL_FULL)
+            printf_P(PSTR(" failed, journal full"));
+    }
+    printf_P(PSTR("\n"));
+}
 
-    /*******************************************/
-    // START OF USER COMMAND SECTION
-    /*******************************************/
+// Check the password entered after cmdSwitchUser() printed the password prompt
+static uint8_t stepSwitchUser(struct CmdThread *thread, uint8_t *login_status)
+{
+    char *cmd;
 
-    else if (strcmp(cmd, "incap") == 0)
+    CMD_BEGIN(thread);
+    CMD_WAIT_UNTIL(thread, cmdIsLineReceived());
+    if((cmd = cliGetArgv(0)) != NULL)
     {
-        #define SIZE 67
-        volatile uint32_t captureArray[SIZE] = {0};
-        printf_P(PSTR("Capturing ICP1 (PB0) ...\n"));
-
-        timer1StartInputCapture(captureArray, SIZE);
+        if (this.echoPassword == 1)
+        {
+            for (int length = strlen(cmd); length; length--)
+                printf_P(PSTR("*"));
+            printf_P(PSTR("\n"));
+        }
 
-        for (uint16_t i = 0; i < SIZE; i++)
+        if (strcmp(cmd, "bhme20") == 0)
         {
-            while (captureArray[i] == 0);   //timer1.c runs ISR to set captureArray[i]
-            if (i % 2 == 0) {
-                printf_P(PSTR("%3d: L: %9.1f us"), i, ((float)captureArray[i]));
-            } else {
-                printf_P(PSTR(", H: %9.1f us\n"), ((float) captureArray[i]));
-            }
+            *login_status = 1;
+            printf_P(PSTR("Press Ctrl+D or enter \"dc\" as " TXT_GREEN_BRIGHT TXT_BOLD "superuser" TXT_RESET_FORMAT " for " TXT_WHITE_BRIGHT "extended " TXT_RESET_FORMAT TXT_UNDERLINED "d" TXT_RESET_FORMAT "efault " TXT_UNDERLINED "c" TXT_RESET_FORMAT "ommands\n"));
         }
-        printf_P(PSTR("\n"));
+        else
+            printf_P(PSTR(TXT_RED_BRIGHT "Denied" TXT_RESET_FORMAT "\n"));
     }
+    else
+        printf_P(PSTR(TXT_RED_BRIGHT "Denied" TXT_RESET_FORMAT "\n"));
+    cliDisablePwdChar();
+    CMD_END(thread);
+}
+
+// Leave the password prompt on Ctrl+C
+static void cancelSwitchUser(uint8_t *login_status)
+{
+    cliDisablePwdChar();
+}
 
-    /*******************************************/
-    // START OF SUPERUSER COMMAND SECTION
-    /*******************************************/
+// su = switch user
+static void executeSu(uint8_t *login_status)
+{
+    cmdSwitchUser(login_status, cfgGet(CFG_ECHO_ALL_COMMANDS));
+}
 
-    // cle = clear EEPROM [all/sfr/var]
-    else if (strcmp(cmd, "cle") == 0 && *login_status == 1)
+// Print a duration given in tenths of microseconds
+static void printTenths(uint32_t tenths)
+{
+    outString_P(PSTR(" "));
+    outFixed(tenths, 1, 7);
+}
+
+// tp = task profile of the Timer2 slots [-/rst]
+static void executeTp(uint8_t *login_status)
+{
+    struct Timer2SlotStats stats;
+
+    // tp rst
+    if (cmdGetArgKeyword(1))
+    {
+        timer2ResetSlotStats();
+        printf_P(PSTR("Resetting task profile: done\n"));
+        return;
+    }
+
+    printf_P(PSTR("Task profile of the 125 us Timer2 slots in us, histogram of durations in us\n"));
+    printf_P(PSTR("Slot    last     min     max    mean  misses |    <1    <2    <4    <8   <16   <32   <64  <128 >=128\n"));
+    for (uint8_t slot = 0; slot < MAX_TIC_TOCS_AVAILABLE; slot++)
     {
-        uint16_t address = 0, start_address = 0, end_address = 0;
-        if ((param = cliGetNextToken()) != NULL)
+        // durations are counted in 0.5 us
+        timer2GetSlotStats(slot, &stats);
+        outUnsigned(slot, 4);
+        printTenths(stats.last * 5UL);
+        printTenths(stats.count ? stats.min * 5UL : 0);
+        printTenths(stats.max * 5UL);
+        printTenths(stats.count ? stats.sum * 5 / stats.count : 0);
+        outString_P(PSTR(" "));
+        outUnsigned(stats.misses, 7);
+        outString_P(PSTR(" |"));
+        for (uint8_t bin = 0; bin < TIMER2_HISTOGRAM_BINS; bin++)
         {
-            // set address ranges for clearing EEPROM at all addresses
-            if (strcmp(param, "all") == 0)
-            {
-                start_address = 0;
-                end_address = EEPROM_ADDRESS_LIMIT;
-            }
-            // set address range for clearing variables stored in EEPROM:
-            else if (strcmp(param, "var") == 0)
-            {
-                start_address = 0;
-                end_address = SFR_IN_EEPROM_OFFSET - 1;
-            }            
-            // set address ranges for clearing SFR-values stored in EEPROM
-            else if (strcmp(param, "sfr") == 0)
-            {
-                start_address = SFR_IN_EEPROM_OFFSET;
-                end_address = EEPROM_ADDRESS_LIMIT;
-            }
-            else
-                printf_P(PSTR("Wrong parameter: %s\n"), param);
-            // erasing the specified memory ranges
-            for(address = start_address; address <= end_address; address++)
-            {
-                if (eeprom_read_byte((uint8_t*) (uintptr_t) address) != 0xFF)
-                {
-                    eeprom_write_byte((uint8_t*) (uintptr_t) address, 0xFF);
-                    printf_P(PSTR("EEPROM cleared at address 0x%03X to: 0xFF\n"), address);
-                }
-            }
-            if (end_address != 0)
-                printf_P(PSTR("Clearing EEPROM: done\n"), address);
+            outString_P(PSTR(" "));
+            outUnsigned(stats.histogram[bin], 5);
         }
+        outString_P(PSTR("\n"));
+    }
+    printf_P(PSTR("Scheduler: %u tasks, %u frame overruns\n"), schedGetTaskCount(), schedGetFrameOverruns());
+    for (uint8_t task = 0; task < schedGetTaskCount(); task++)
+    {
+        printf_P(PSTR("Task %u: %u overruns, "), task, schedGetOverruns(task));
+        if (schedGetFlags(task) & SCHED_DEMOTED)
+            printf_P(PSTR("demoted to soft\n"));
+        else if (schedGetFlags(task) & SCHED_SOFT)
+            printf_P(PSTR("soft\n"));
         else
+            printf_P(PSTR("hard\n"));
+    }
+}
+
+// Soft tasks of watch, one per CLI instance, flag the next run of the watched command
+static void watchTask0()
+{
+    instances[0].watchDue = 1;
+}
+
+#if CLI_INSTANCES > 1
+static void watchTask1()
+{
+    instances[1].watchDue = 1;
+}
+#endif
+
+#if CLI_INSTANCES > 2
+static void watchTask2()
+{
+    instances[2].watchDue = 1;
+}
+#endif
+
+#if CLI_INSTANCES > 3
+static void watchTask3()
+{
+    instances[3].watchDue = 1;
+}
+#endif
+
+// Soft task of watch of each CLI instance
+static void (* const watchTasks[CLI_INSTANCES])() =
+{
+    watchTask0,
+    #if CLI_INSTANCES > 1
+    watchTask1,
+    #endif
+    #if CLI_INSTANCES > 2
+    watchTask2,
+    #endif
+    #if CLI_INSTANCES > 3
+    watchTask3,
+    #endif
+};
+
+// Run the watched command whenever due, its previous output is overwritten in place
+static uint8_t stepWatch(struct CmdThread *thread, uint8_t *login_status)
+{
+    CMD_BEGIN(thread);
+    while (1)
+    {
+        CMD_WAIT_UNTIL(thread, this.watchDue);
+        this.watchDue = 0;
+        cliRewindOutput();
+        this.watchHandler(login_status);
+        // a watched command waiting itself continues as the pending command, watch ends
+        if (this.step != stepWatch)
         {
-            printf_P(PSTR("Clear EEPROM\n"));
-            printf_P(PSTR("Clearing EEPROM at all addresses:      \"cle all\", address range: [0x000, 0x%03X]\n"), EEPROM_ADDRESS_LIMIT);
-            printf_P(PSTR("Clearing Variables written to EEPROM:  \"cle var\", address range: [0x000, 0x%03X]\n"), SFR_IN_EEPROM_OFFSET - 1);
-            printf_P(PSTR("Clearing SFR-values written to EEPROM: \"cle sfr\", address range: [0x%03X, 0x%03X]\n"), SFR_IN_EEPROM_OFFSET, EEPROM_ADDRESS_LIMIT);
+            schedSetPeriod(this.watchTask, 0, 0);
+            return CMD_PENDING;
         }
     }
+    CMD_END(thread);
+}
+
+// Stop the runs of watch on Ctrl+C
+static void cancelWatch(uint8_t *login_status)
+{
+    schedSetPeriod(this.watchTask, 0, 0);
+    this.watchDue = 0;
+}
+
+// watch = run a command periodically MS CMD [PARAMS]
+static void executeWatch(uint8_t *login_status)
+{
+    uint16_t period = cmdGetArgValue(1);
+    uint8_t status;
 
-    // eep = eeprom access [ADDR] [-/VAL]
-    else if (strcmp(cmd, "eep") == 0 && *login_status == 1)
+    if (period == 0)
     {
-        uint16_t address = 0;
-        uint16_t hexValue = 0;
-        char readHexFailed = '\0';
-        if ((param = cliGetNextToken()) != NULL)
-        {
-            if (sscanf(param, "%x%c", &address, &readHexFailed) == 1 && address <= EEPROM_ADDRESS_LIMIT)
-                printf_P(PSTR("EEPROM reading at address 0x%03X: 0x%02X\n"), address, eeprom_read_byte((uint8_t*) (uintptr_t) address));
-            else if (strcmp(param, "all") == 0)
-            {
-                for(address = 0; address <= EEPROM_ADDRESS_LIMIT; address++)
-                {
-                    hexValue = eeprom_read_byte((uint8_t*) (uintptr_t) address);
-                    if (hexValue != 0xFF)
-                        printf_P(PSTR("EEPROM value at address 0x%03X: 0x%02X\n"), address, hexValue);
-                }
-                printf_P(PSTR("Reading all written EEPROM values: done\n"), address);
-            }
-            else
-                printf_P(PSTR("EEPROM address not valid: %s\n"), param);
+        printf_P(PSTR("Watch period of 1 to %u ms expected\n"), WATCH_PERIOD_MAX);
+        return;
+    }
 
-            if ((param = cliGetNextToken()) != NULL && address <= EEPROM_ADDRESS_LIMIT)
-            {
-                if (sscanf(param, "%x%c", &hexValue, &readHexFailed) == 1 && hexValue <= 0xFF)
-                {
-                    printf_P(PSTR("EEPROM writing at address 0x%03X: 0x%02X\n"), address, (uint8_t) hexValue);
-                    eeprom_write_byte((uint8_t*) (uintptr_t) address, (uint8_t)hexValue);                            
-                }
-                else
-                    printf_P(PSTR("Wrong parameter: %s\n"), param);
-            }
+    // bind the command once, each run calls its handler with the parameters converted here
+    cliShiftArgv(2);
+    status = cmdBindCommand(*login_status, &this.watchHandler);
+    if (status == CMD_INVALID)
+        return;
+    if (status == CMD_UNKNOWN || this.watchHandler == executeWatch)
+    {
+        printf_P(PSTR("Command not available for watch: %s\n"), cliGetArgv(0));
+        return;
+    }
+    if (this.watchTask == SCHED_INVALID_TASK)
+        this.watchTask = schedAddTask(watchTasks[cliGetInstance()], period * SCHED_FRAMES_PER_MS, 0, SCHED_SOFT);
+    if (this.watchTask == SCHED_INVALID_TASK)
+    {
+        printf_P(PSTR("No scheduler task left for watch\n"));
+        return;
+    }
+
+    printf_P(PSTR("Every %u ms: %s, Ctrl+C to stop\n"), period, cliGetArgv(0));
+    cliMarkOutput();
+    this.watchDue = 0;
+    schedSetPeriod(this.watchTask, period * SCHED_FRAMES_PER_MS, 0);
+    cmdResume(stepWatch, cancelWatch);
+}
+
+// Default command table, sorted by name for binary search
+static const struct CmdEntry defaultCommands[] PROGMEM =
+{
+    {"ac",  executeAc,  CMD_USER,       CTRL_A, "Application commands",     "-"},
+    {"cd",  executeCd,  CMD_USER,       0,      "Command details",          "[0/1]",
+        "", {CMD_DEC(1, CMD_ARG_OPTIONAL)}},
+    {"ce",  executeCe,  CMD_USER,       0,      "Command echo",             "[0/1]",
+        "", {CMD_DEC(1, CMD_ARG_OPTIONAL)}},
+    #ifdef UART_ISR_CHARACTER_ECHOING
+    {"ch",  executeCh,  CMD_USER,       0,      "Command history",          "[0/1]",
+        "", {CMD_DEC(1, CMD_ARG_OPTIONAL)}},
+    #endif
+    {"cle", executeCle, CMD_SUPERUSER,  0,      "Clear EEPROM",             "[all/var/sfr]",
+        CLE_KEYWORDS, {CMD_WORD(CMD_ARG_OPTIONAL)}},
+    {"clh", executeClh, CMD_USER,       0,      "Clear history",            "-"},
+    {"cls", executeCls, CMD_USER,       CTRL_L, "Clear screen",             "-"},
+    {"dc",  executeDc,  CMD_USER,       CTRL_D, "Default commands",         "-"},
+    {"eep", executeEep, CMD_SUPERUSER,  0,      "EEPROM access",            "[ADDR/all] [-/VAL]",
+        "all", {CMD_HEX(EEPROM_ADDRESS_LIMIT, CMD_ARG_KEYWORD | CMD_ARG_OPTIONAL), CMD_HEX8(CMD_ARG_OPTIONAL)}},
+    {"rb",  executeRb,  CMD_SUPERUSER,  CTRL_Y, "Ring buffer",              "-"},
+    {"rst", executeRst, CMD_USER,       0,      "Reset",                    "-"},
+    {"sb",  executeSb,  CMD_USER,       0,      "Status bar",               "[0/1] [-/ROWS]",
+        "", {CMD_DEC(1, CMD_ARG_OPTIONAL), CMD_DEC(0xFF, CMD_ARG_OPTIONAL)}},
+    {"sfr", executeSfr, CMD_SUPERUSER,  0,      "SFR access",               "[ADDR] [-/VAL] [-/wte]",
+        "wte", {CMD_HEX8(CMD_ARG_OPTIONAL), CMD_HEX16(CMD_ARG_OPTIONAL), CMD_WORD(CMD_ARG_OPTIONAL)}},
+    {"su",  executeSu,  CMD_USER,       CTRL_U, "Switch user",              "-"},
+    {"tp",  executeTp,  CMD_USER,       0,      "Task profile",             "[-/rst]",
+        "rst", {CMD_WORD(CMD_ARG_OPTIONAL)}},
+    {"watch", executeWatch, CMD_USER,   0,      "Watch command",            "MS CMD [PARAMS]",
+        "", {CMD_DEC(WATCH_PERIOD_MAX, 0), CMD_TEXT(0)}},
+};
+
+// Binary search for a command name in a sorted command table stored in program memory
+// Return value:    1: command found and copied to entry
+//                  0: command not found
+static uint8_t findCommand(const struct CmdEntry *table, uint8_t count, const char *name, struct CmdEntry *entry)
+{
+    uint8_t low = 0, high = count;
+    while (low < high)
+    {
+        uint8_t mid = (low + high) / 2;
+        int result = strcmp_P(name, table[mid].name);
+        if (result == 0)
+        {
+            memcpy_P(entry, &table[mid], sizeof(struct CmdEntry));
+            return 1;
         }
+        if (result < 0)
+            high = mid;
         else
+            low = mid + 1;
+    }
+    return 0;
+}
+
+// Linear search for a CTRL-key shortcut in a command table stored in program memory
+// Return value:    1: shortcut found and command copied to entry
+//                  0: shortcut not assigned
+static uint8_t findShortcut(const struct CmdEntry *table, uint8_t count, char ctrlKey, struct CmdEntry *entry)
+{
+    for (uint8_t i = 0; i < count; i++)
+        if (pgm_read_byte(&table[i].shortcut) == ctrlKey)
         {
-            printf_P(PSTR("EEPROM access\n"));
-            printf_P(PSTR("Reading all values written to EEPROM:  \"eep all\"\n"));
-            printf_P(PSTR("Reading a single value from EEPROM:    \"eep [ADDR]\", address range: [0x0, 0x%03X]\n"), EEPROM_ADDRESS_LIMIT);
-            printf_P(PSTR("Writing a single value to EEPROM:      \"eep [ADDR] [VAL]\", value range: [0x0, 0xFF]\n"));
+            memcpy_P(entry, &table[i], sizeof(struct CmdEntry));
+            return 1;
         }
+    return 0;
+}
+
+// Print all commands of a command table with the given privilege
+static void printCommands(const struct CmdEntry *table, uint8_t count, uint8_t privilege)
+{
+    struct CmdEntry entry;
+    for (uint8_t i = 0; i < count; i++)
+    {
+        memcpy_P(&entry, &table[i], sizeof(struct CmdEntry));
+        if (entry.privilege != privilege)
+            continue;
+        printf_P(PSTR("%s\t%-32s%-24s"), entry.name, entry.description, entry.params);
+        if (entry.shortcut)
+            printf_P(PSTR("Ctrl+%c\n"), 'A' + entry.shortcut - 1);
+        else
+            printf_P(PSTR("-\n"));
     }
+}
 
-    // sfr = special function register access [ADDR] [-/VAL]
-    else if (strcmp(cmd, "sfr") == 0 && *login_status == 1)
+// Get the position of token in the space separated keywords (1 = first keyword)
+// Return value: 0 if token is no keyword
+static uint8_t findKeyword(const char *keywords, const char *token)
+{
+    uint8_t position = 1;
+    uint8_t length;
+
+    while (*keywords != '\0')
     {
-        uint16_t address = 0;
-        uint16_t hexValue = 0;
-        uint8_t intFlag = 0;
-        char readHexFailed = '\0';
-        if ((param = cliGetNextToken()) != NULL)
-        {
-            if (sscanf(param, "%x%c", &address, &readHexFailed) == 1 && address <= 0xFF)
-            {
-                printf_P(PSTR("SFR reading at address 0x%02X: "), address);
-                if((address >= 0x84 && address <= 0x8A) || address == 0xC4)
-                {
-                    printf_P(PSTR("0x%02X\n"), cmdRead16BitRegister((uint8_t) address));
-                    intFlag = 1;
-                }
-                else
-                    printf_P(PSTR("0x%02X\n"), cmdRead8BitRegister((uint8_t) address));
-            }
-            else
-                printf_P(PSTR("SFR address not valid: %s\n"), param);
+        for (length = 0; keywords[length] != '\0' && keywords[length] != ' '; length++);
+        if (strncmp(keywords, token, length) == 0 && token[length] == '\0')
+            return position;
+        keywords += length;
+        if (*keywords == ' ')
+            keywords++;
+        position++;
+    }
+    return 0;
+}
 
-            if ((param = cliGetNextToken()) != NULL && address <= 0xFF)
-            {
-                if (sscanf(param, "%x%c", &hexValue, &readHexFailed) == 1)
-                {
-                    printf_P(PSTR("SFR writing at address 0x%02X: "), address);
-                    if (intFlag)
-                    {
-                        printf_P(PSTR("0x%04X "), hexValue);
-                        _delay_ms(1);
-                        cmdWrite16BitRegister((uint8_t) address, hexValue);
-                    }
-                    else
-                    {
-                        printf_P(PSTR("0x%02X "), (uint8_t) hexValue);
-                        _delay_ms(1);
-                        cmdWrite8BitRegister((uint8_t) address, (uint8_t) hexValue);               
-                    }                  
-                }
-                else
-                    printf_P(PSTR("Wrong parameter: %s\n"), param);
-                
-                if ((param = cliGetNextToken()) != NULL)
-                {
-                    if (strcmp(param, "wte") == 0)
-                    {
-                        printf_P(PSTR("writing to EEPROM at address: 0x%03X"), address + SFR_IN_EEPROM_OFFSET);
-                        if(intFlag)
-                            eeprom_write_word((uint16_t*) (uintptr_t) (address + SFR_IN_EEPROM_OFFSET), hexValue);
-                        else
-                            eeprom_write_byte((uint8_t*) (uintptr_t) (address + SFR_IN_EEPROM_OFFSET), (uint8_t)hexValue);
-                    }
-                }
-                printf_P(PSTR("\n"));
-            }
-        }
+// Convert token to a number of base 16 or 10 up to max without scanf, hexadecimal numbers may start with 0x
+// Return value:    1: number converted to *value
+//                  0: no number or larger than max
+static uint8_t parseNumber(const char *token, uint8_t base, uint16_t max, uint16_t *value)
+{
+    uint32_t number = 0;
+    uint8_t digit;
+    char c;
+
+    if (base == 16 && token[0] == '0' && (token[1] == 'x' || token[1] == 'X'))
+        token += 2;
+    if (*token == '\0')
+        return 0;
+    while ((c = *token++) != '\0')
+    {
+        if (c >= '0' && c <= '9')
+            digit = c - '0';
+        else if (base == 16 && (c | 0x20) >= 'a' && (c | 0x20) <= 'f')
+            digit = (c | 0x20) - 'a' + 10;
         else
+            return 0;
+        number = number * base + digit;
+        if (number > max)
+            return 0;
+    }
+    *value = number;
+    return 1;
+}
+
+// Check and convert the parameters received by the argument schema of entry
+// Return value:    1: parameters converted to this.argValues and this.argKeywords
+//                  0: parameter missing or invalid, reported already
+static uint8_t convertArgs(const struct CmdEntry *entry)
+{
+    const struct CmdArg *arg;
+    const char *token;
+    uint8_t type;
+
+    memset(this.argValues, 0, sizeof(this.argValues));
+    memset(this.argKeywords, 0, sizeof(this.argKeywords));
+    for (uint8_t index = 0; index < CMD_ARGS_MAX && entry->args[index].type != CMD_ARG_NONE; index++)
+    {
+        arg = &entry->args[index];
+        type = arg->type & CMD_ARG_TYPE_MASK;
+        if ((token = cliGetArgv(index + 1)) == NULL)
         {
-            printf_P(PSTR("Special function register access\n"));
-            printf_P(PSTR("Reading a Special Function Register:   \"sfr [ADDR]\", address range: [0x0, 0xFF]\n"));
-            printf_P(PSTR("Writing a Special Function Register:   \"sfr [ADDR] [VAL]\", value range: [0x0, 0xFFFF]\n"));
-            printf_P(PSTR("Writing the SFR-value also to EEPROM:  \"sfr [ADDR] [VAL] wte\", EEPROM-address: ADDR+0x%03X\n"), SFR_IN_EEPROM_OFFSET);
+            if (arg->type & CMD_ARG_OPTIONAL)
+                break;
+            printf_P(PSTR("Missing parameter, expected: %s %s\n"), entry->name, entry->params);
+            return 0;
         }
-    }    
+        if (type == CMD_ARG_TEXT)
+            continue;
+        if ((type == CMD_ARG_WORD || (arg->type & CMD_ARG_KEYWORD)) &&
+            (this.argKeywords[index] = findKeyword(entry->keywords, token)) != 0)
+            continue;
+        if ((type == CMD_ARG_HEX || type == CMD_ARG_DEC) &&
+            parseNumber(token, type == CMD_ARG_HEX ? 16 : 10, arg->max, &this.argValues[index]))
+            continue;
+        printf_P(PSTR("Wrong parameter: %s, expected: %s %s\n"), token, entry->name, entry->params);
+        return 0;
+    }
+    return 1;
+}
+
+// Call the step of the pending command
+// Return value:    1: command completed
+//                  0: command still pending
+static uint8_t runStep(uint8_t *login_status)
+{
+    if (this.step(&this.thread, login_status) == CMD_PENDING)
+        return 0;
+    this.step = NULL;
+    return 1;
+}
+
+// Cancel the pending command if Ctrl+C has been received
+// Return value:    1: command cancelled
+//                  0: command still pending
+static uint8_t cancelOnCtrlC(uint8_t *login_status)
+{
+    if (this.ctrlKey != CTRL_C && cliGetCtrlKey() != CTRL_C)
+        return 0;
+    printf_P(PSTR("Cancelled\n"));
+    return cmdCancel(login_status);
+}
+
+/****************************************************/
+// GLOBAL FUNCTIONS
+/****************************************************/
+
+// Executes all commands defined
+// A command line or CTRL-key received while a command is pending is handed over to the pending command
+uint8_t cmdExecuteCommand(uint8_t *login_status)
+{
+    char charCtrlKey;
+    struct CmdEntry entry;
+    CmdHandler handler;
+    uint8_t found, status;
 
-    // rst = reset
-    else if (strcmp(cmd, "rst") == 0)
+    if (this.step != NULL)
     {
-        printf_P(PSTR(CLEAR_SCREEN SHOW_CURSOR));
-        wdt_enable(WDTO_15MS); // Enable the WDT and set its timeout to 15ms
-        while(1); // Wait for the WDT to reset the microcontroller
+        if (!cancelOnCtrlC(login_status))
+        {
+            this.lineReceived = 1;
+            runStep(login_status);
+            this.lineReceived = 0;
+        }
+        return 1;
     }
 
-    // rb = ring buffer (holds the last command line inputs)
-    else if (strcmp(cmd, "rb") == 0 && *login_status == 1)
+    // Hand over the status bar flag from the configuration to cliSetStatusBarFlag, shown by the console only
+    if (cliGetInstance() == 0)
+        cliSetStatusBarFlag(cfgGet(CFG_STATUS_BAR));
+
+    // Echo all commands if not in terminal mode in VSC and UART_ISR_CHARACTER_ECHOING is not defined
+    if (cfgGet(CFG_ECHO_ALL_COMMANDS) == 1)
+        cliPrintRcvdString();   
+    
+    // Print received command and parameters, returns num_of_params
+    if (cfgGet(CFG_COMMAND_DETAILS) == 1)
+        cliPrintCmdDetails();
+
+    // Check for received CTRL-Keys
+    if ((charCtrlKey = cliGetCtrlKey()) != 0)
     {
-        cliPrintRingBuffer();
+        found = findShortcut(defaultCommands, DEFAULT_COMMANDS_COUNT, charCtrlKey, &entry) ||
+                findShortcut(applicationCommands, applicationCommandsCount, charCtrlKey, &entry);
+        if (found && entry.privilege <= *login_status)
+            entry.handler(login_status);
+        else
+            printf_P(PSTR("Ctrl+%c not assigned\n"), 'A' + charCtrlKey - 1);
     }
 
-    // Unknown Command
-    else
+    // cliGetArgv(0) returns the first space separated string received, which is defined to be the command
+    else if (cliGetArgv(0) != NULL)
     {
-        //printf_P(PSTR("Unknown command: "));
-        //printf_P(PSTR("[%s]\n"), cmd);
-        if (eeprom_read_byte(&commandHistoryFlag) == 1)
-            cliPrintCmdHistory();
-        return 0;
+        // Unknown Command or missing privilege
+        if ((status = cmdBindCommand(*login_status, &handler)) == CMD_UNKNOWN)
+        {
+            //printf_P(PSTR("Unknown command: "));
+            //printf_P(PSTR("[%s]\n"), cmd);
+            if (cfgGet(CFG_COMMAND_HISTORY) == 1)
+                cliPrintCmdHistory();
+            return 0;
+        }
+        // Parameters not matching the argument schema are reported by cmdBindCommand()
+        if (status == CMD_BOUND)
+            handler(login_status);
     }
 
-    if (eeprom_read_byte(&commandHistoryFlag) == 1)
+    // Run a resumable command up to its first wait
+    if (this.step != NULL)
+        runStep(login_status);
+
+    if (cfgGet(CFG_COMMAND_HISTORY) == 1)
         cliPrintCmdHistory();
 
     return 1;
 }
 
+// Continue the command executing in step, called by a command handler before it returns
+// step is called from the main loop by cmdService() until it returns CMD_DONE, on Ctrl+C cancel is called
+// instead, it may be NULL. Received characters are ignored while step waits unless it prints a prompt
+void cmdResume(CmdStep step, CmdHandler cancel)
+{
+    this.step = step;
+    this.cancel = cancel;
+    this.thread.line = 0;
+    this.lineReceived = 0;
+    this.ctrlKey = 0;
+    // a prompt printed by the command resets the CTRL-key pointer to receive a command line
+    cliEnableCtrlKeys(&this.ctrlKey);
+}
+
+// Call the step of the pending command, call cyclically from the main loop
+// Return value:    1: pending command completed or cancelled, print the prompt
+//                  0: no command pending or the command is still pending
+uint8_t cmdService(uint8_t *login_status)
+{
+    if (this.step == NULL)
+        return 0;
+    if (cancelOnCtrlC(login_status))
+        return 1;
+    return runStep(login_status);
+}
+
+// Cancel the pending command as on Ctrl+C without printing, e.g. requested by the binary protocol
+// Return value:    1: command cancelled
+//                  0: no command pending
+uint8_t cmdCancel(uint8_t *login_status)
+{
+    if (this.step == NULL)
+        return 0;
+    if (this.cancel != NULL)
+        this.cancel(login_status);
+    this.step = NULL;
+    return 1;
+}
+
+// Get if a command is pending, the prompt is printed once it completed
+uint8_t cmdIsPending()
+{
+    return this.step != NULL;
+}
+
+// Get if the pending command is called with a command line received, e.g. after printing a password prompt
+uint8_t cmdIsLineReceived()
+{
+    return this.lineReceived;
+}
+
+// Look up the command cliGetArgv(0) available with login_status, default commands are searched first,
+// and check and convert its parameters by the argument schema of the command
+// Return value:    CMD_BOUND: *handler set, converted parameters available by cmdGetArgValue() and cmdGetArgKeyword()
+//                  CMD_UNKNOWN: command unknown or requiring a higher privilege
+//                  CMD_INVALID: parameters not matching the argument schema, reported already
+uint8_t cmdBindCommand(uint8_t login_status, CmdHandler *handler)
+{
+    struct CmdEntry entry;
+    const char *name = cliGetArgv(0);
+
+    if (name == NULL)
+        return CMD_UNKNOWN;
+    if (!findCommand(defaultCommands, DEFAULT_COMMANDS_COUNT, name, &entry) &&
+        !findCommand(applicationCommands, applicationCommandsCount, name, &entry))
+        return CMD_UNKNOWN;
+    if (entry.privilege > login_status)
+        return CMD_UNKNOWN;
+    if (!convertArgs(&entry))
+        return CMD_INVALID;
+    *handler = entry.handler;
+    return CMD_BOUND;
+}
+
+// Get the number converted from parameter index (1 = first parameter) by the argument schema
+// Return value: 0 if the parameter is missing, a keyword or not converted
+uint16_t cmdGetArgValue(uint8_t index)
+{
+    if (index == 0 || index > CMD_ARGS_MAX)
+        return 0;
+    return this.argValues[index - 1];
+}
+
+// Get the keyword given as parameter index (1 = first parameter)
+// Return value: position of the keyword in the keywords of the command (1 = first), 0 if no keyword was given
+uint8_t cmdGetArgKeyword(uint8_t index)
+{
+    if (index == 0 || index > CMD_ARGS_MAX)
+        return 0;
+    return this.argKeywords[index - 1];
+}
+
 // Shows the default commands
 void cmdShowDefaultCommands(uint8_t superuser_flag)
 {
     printf_P(PSTR(      HIDE_CURSOR
                         "Default commands\n"
                         "Enter any command (Cmd) without parameter for help or status information\n\n"
-                        TXT_UNDERLINED "Cmd\tDescription\t\t\tParameter\t\tShortcut\n" TXT_RESET_FORMAT
-                        "ac\tApplication commands\t\t-\t\t\tCtrl+A\n"
-                        "cd\tCommand details\t\t\t[0/1]\t\t\t-\n"
-                        "ce\tCommand echo\t\t\t[0/1]\t\t\t-\n"));
-
-    #ifdef UART_ISR_CHARACTER_ECHOING                        
-    printf_P(PSTR(      "ch\tCommand history\t\t\t[0/1]\t\t\t-\n"));
-    #endif  
-
-    printf_P(PSTR(      "clh\tClear history\t\t\t-\t\t\t-\n"
-                        "cls\tClear screen\t\t\t-\t\t\tCtrl+L\n"
-                        "dc\tDefault commands\t\t-\t\t\tCtrl+D\n"
-                        "rst\tReset\t\t\t\t-\t\t\t-\n"
-                        "sb\tStatus bar\t\t\t[0/1]\t\t\t-\n"
-                        "su\tSwitch user\t\t\t-\t\t\tCtrl+U\n"));
+                        TXT_UNDERLINED "Cmd\tDescription\t\t\tParameter\t\tShortcut\n" TXT_RESET_FORMAT));
+
+    printCommands(defaultCommands, DEFAULT_COMMANDS_COUNT, CMD_USER);
 
     #ifdef SHOW_TERMINAL_SHORTCUTS
     printf_P(PSTR(                        
@@ -424,12 +930,11 @@ void cmdShowDefaultCommands(uint8_t superuser_flag)
     #endif
 
     if (superuser_flag == 1)
+    {
         printf_P(PSTR(  TXT_UNDERLINED 
-                        "\nSU-Cmd\tDescription\t\t\tParameter\t\tShortcut\n" TXT_RESET_FORMAT
-                        "cle\tClear EEPROM\t\t\t[all/var/sfr]\n"
-                        "eep\tEEPROM access\t\t\t[ADDR/all] [-/VAL]\n"
-                        "rb\tRing buffer\t\t\t-\t\t\tCtrl+Y\n"
-                        "sfr\tSFR access\t\t\t[ADDR] [-/VAL] [-/wte]\n"));
+                        "\nSU-Cmd\tDescription\t\t\tParameter\t\tShortcut\n" TXT_RESET_FORMAT));
+        printCommands(defaultCommands, DEFAULT_COMMANDS_COUNT, CMD_SUPERUSER);
+    }
 
     printf_P(PSTR(SHOW_CURSOR));
 }
@@ -440,41 +945,66 @@ void cmdShowApplicationCommands()
     printf_P(PSTR(      HIDE_CURSOR
                         "Application commands\n"
                         "Enter any command (Cmd) without parameter for help or status information\n\n"
-                        TXT_UNDERLINED "Cmd\tDescription\t\t\tParameter\t\tShortcut\n" TXT_RESET_FORMAT SHOW_CURSOR));
+                        TXT_UNDERLINED "Cmd\tDescription\t\t\tParameter\t\tShortcut\n" TXT_RESET_FORMAT));
+    printCommands(applicationCommands, applicationCommandsCount, CMD_USER);
+    printCommands(applicationCommands, applicationCommandsCount, CMD_SUPERUSER);
+    printf_P(PSTR(SHOW_CURSOR));
+}
+
+// Register the application's command table stored in program memory (PROGMEM)
+// Return value:    1: command table registered
+//                  0: table not sorted by name, not registered
+uint8_t cmdSetApplicationCommands(const struct CmdEntry *table, uint8_t count)
+{
+    char name[CMD_NAME_SIZE];
+    for (uint8_t i = 1; i < count; i++)
+    {
+        memcpy_P(name, table[i - 1].name, CMD_NAME_SIZE);
+        if (strcmp_P(name, table[i].name) >= 0)
+        {
+            printf_P(PSTR("Error: application commands not sorted at \"%s\".\n"), name);
+            return 0;
+        }
+    }
+    applicationCommands = table;
+    applicationCommandsCount = count;
+    return 1;
 }
 
-// Sets a flag to store 0/1 information in EEPROM
-void cmdSetFlag(uint8_t *variable)
+// Sets a configuration item to store 0/1 information persistently
+void cmdSetFlag(uint8_t item)
 {
-    uint8_t flag = eeprom_read_byte(variable);
-    char *param = cliGetNextToken();
+    uint8_t flag = cfgGet(item);
+    uint8_t saved = 1;
+    char *param = cliGetArgc() > 1 ? cliGetArgv(1) : "";
     if (*param == '1' || (*param != '0' && flag == 1))
     {
         if (flag != 1)
         {
-            eeprom_write_byte(variable, 1);
+            saved = cfgSet(item, 1);
             printf_P(PSTR(" changed"));
         }
-        printf_P(PSTR(": on\n"));
+        printf_P(PSTR(": on"));
     }
-    else if (*param == '0' || flag == 0xFF)
+    else if (*param == '0' || flag == 0)
     {
-        if (flag != 0xFF)
+        if (flag != 0)
         {
-            eeprom_write_byte(variable, 0xFF);
+            saved = cfgSet(item, 0);
             printf_P(PSTR(" changed"));
         }
-        printf_P(PSTR(": off\n"));
+        printf_P(PSTR(": off"));
     }
-    else
-        printf_P(PSTR("\n"));
+    if (!saved)
+        printf_P(PSTR(", not saved to EEPROM: journal full"));
+    printf_P(PSTR("\n"));
 }
 
 // Reads 8 Bit SFR
 uint8_t cmdRead8BitRegister(uint8_t address)
 {
     // Convert the address to pointer: volatile uint8_t *
-    volatile uint8_t *regPtr = (volatile uint8_t *)(uintptr_t)address;
+    volatile uint8_t *regPtr = HAL_SFR8(address);
     // Dereference the pointer to read the value from the register
     return *regPtr;
 }
@@ -483,94 +1013,87 @@ uint8_t cmdRead8BitRegister(uint8_t address)
 void cmdWrite8BitRegister(uint8_t address, uint8_t byte)
 {
     // Convert the address to pointer: volatile uint8_t *
-    volatile uint8_t *regPtr = (volatile uint8_t *)(uintptr_t)address;
+    volatile uint8_t *regPtr = HAL_SFR8(address);
     // Assign byte to dereferenced register pointer
     *regPtr = byte;
 }
 
-// Reads 16 Bit SFR
+// Reads 16 Bit SFR, low byte first with interrupts masked
+// as the high byte is latched in the shared TEMP register
 uint16_t cmdRead16BitRegister(uint8_t address)
 {
-    // Convert the base address to pointer: volatile uint16_t *
-    volatile uint16_t *regPtr = (volatile uint16_t *)((uintptr_t)address);
-    // Read the value from the register
-    return *regPtr;
+    // Convert the base address to pointer: volatile uint8_t *
+    volatile uint8_t *regPtr = HAL_SFR8(address);
+    uint16_t value = 0;
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+    {
+        value = regPtr[0];
+        value |= regPtr[1] << 8;
+    }
+    return value;
 }
 
-// WriteSFR16
+// Writes 16 Bit SFR, high byte first with interrupts masked
+// as the high byte is latched in the shared TEMP register
 void cmdWrite16BitRegister(uint8_t address, uint16_t value)
 {
-    // Convert the base address to pointer: volatile uint16_t *
-    volatile uint16_t *regPtr = (volatile uint16_t *)((uintptr_t)address);
-    // Write the value to the register
-    *regPtr = value;
+    // Convert the base address to pointer: volatile uint8_t *
+    volatile uint8_t *regPtr = HAL_SFR8(address);
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+    {
+        regPtr[1] = (uint8_t) (value >> 8);
+        regPtr[0] = (uint8_t) value;
+    }
 }
 
-// Updates special function register at "address" from EEPROM
-uint8_t cmdUpdateSfrFromEEPROM(uint8_t address)
+// Updates special function register at "address" from EEPROM using its persisted width
+// Return value: current value of the register
+uint16_t cmdUpdateSfrFromEEPROM(uint8_t address, uint8_t quiet)
 {
-    uint8_t *reg = (uint8_t *) (uintptr_t) address;
-    const uint8_t *eepromPtr = (const uint8_t *) (uintptr_t) (address + SFR_IN_EEPROM_OFFSET);
-    uint8_t eepromValue  = eeprom_read_byte (eepromPtr);
+    const struct JournalEntry *entry = journalFind(JOURNAL_TYPE_SFR, address);
 
-    if (eepromValue != 0xFF)
-    {
-        printf_P(PSTR("Value 0x%02X loaded from EEPROM, updating SFR at address: 0x%02X\n"), eepromValue, address);
-        *reg = eepromValue;
-        return eepromValue;
-    }
+    if (entry == NULL)
+        return cmdRead8BitRegister(address);
+
+    if (!quiet)
+        printf_P(PSTR("Value 0x%02X loaded from EEPROM, updating SFR at address: 0x%02X\n"), entry->value, address);
+    if (entry->type == JOURNAL_TYPE_SFR16)
+        cmdWrite16BitRegister(address, entry->value);
     else
-        return *reg;
+        cmdWrite8BitRegister(address, (uint8_t) entry->value);
+    return entry->value;
 }
 
-// Updates all special function registers from EEPROM
-void cmdUpdateAllSfrFromEEPROM()
+// Updates all special function registers persisted in EEPROM, the journal's index
+// lists them, so only persisted registers are accessed
+// Return value: number of registers updated
+uint8_t cmdUpdateAllSfrFromEEPROM(uint8_t quiet)
 {
-    uint8_t sfr_address = 0xFF;
-    while(sfr_address--)
-        cmdUpdateSfrFromEEPROM(sfr_address);
-    cmdUpdateSfrFromEEPROM(0);
+    const struct JournalEntry *entry;
+    uint8_t count = 0;
+
+    // persisted UART registers take effect on the next character
+    cliFlushTx();
+    for (uint8_t i = 0; (entry = journalGetEntry(i)) != NULL; i++)
+        if ((entry->type & JOURNAL_TYPE_MASK) == JOURNAL_TYPE_SFR)
+        {
+            cmdUpdateSfrFromEEPROM(entry->key, quiet);
+            count++;
+        }
+    return count;
 }
 
 // Switches user from standard to superuser or vice versa
+// The password is read by a pending command, call from a command handler only
 void cmdSwitchUser(uint8_t *login_status, uint8_t echoAllCommandsFlag)
 {
-    char *cmd;
-    unsigned long seconds_change = 0;
     printf_P(PSTR("Switch user\n"));
     if (*login_status == 0)
     {
+        this.echoPassword = echoAllCommandsFlag;
+        cmdResume(stepSwitchUser, cancelSwitchUser);
         cliEnablePwdChar();
-        cliPrintPrompt(NULL, "Password>", CMD_LEVEL);
-        while (!cliProcessRxData())
-        {
-            if (cliGetStatusBarFlag() == 1 && seconds_change != timer2GetSeconds())
-            {
-                seconds_change = timer2GetSeconds();
-                cliPrintStatusBar(HIDE_CURSOR_ON);
-            }
-        }
-
-        if((cmd = cliGetFirstToken()) != NULL)
-        {
-            if (echoAllCommandsFlag == 1)
-            {
-                for (int length = strlen(cmd); length; length--)
-                    printf_P(PSTR("*"));
-                printf_P(PSTR("\n"));
-            }
-
-            if (strcmp(cmd, "bhme20") == 0)
-            {
-                *login_status = 1;
-                printf_P(PSTR("Press Ctrl+D or enter \"dc\" as " TXT_GREEN_BRIGHT TXT_BOLD "superuser" TXT_RESET_FORMAT " for " TXT_WHITE_BRIGHT "extended " TXT_RESET_FORMAT TXT_UNDERLINED "d" TXT_RESET_FORMAT "efault " TXT_UNDERLINED "c" TXT_RESET_FORMAT "ommands\n"));
-            }
-            else
-                printf_P(PSTR(TXT_RED_BRIGHT "Denied" TXT_RESET_FORMAT "\n"));
-        }
-        else
-            printf_P(PSTR(TXT_RED_BRIGHT "Denied" TXT_RESET_FORMAT "\n"));
-        cliDisablePwdChar();
+        cliPrintPrompt("", "Password>", CMD_LEVEL);
     }
     else
         *login_status = 0;
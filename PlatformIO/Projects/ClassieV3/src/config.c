@@ -0,0 +1,232 @@
+/*
+ * File:            config.c
+ * Author:          Thomas Jerman
+ * Date Created:    18.10.2026
+ *
+ * Description:
+ * Providing persistent configuration items mirrored in RAM
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include <avr/io.h>
+#include <avr/pgmspace.h>
+
+#include "config.h"
+#include "eeq.h"
+#include "hal.h"
+#include "journal.h"
+
+/****************************************************/
+// LOCAL DEFINES
+/****************************************************/
+
+#define CFG_VERSION_KEY 0xFF    // journal key of the configuration version
+
+// EEPROM layout used before the journal: the flags at the addresses [0, CFG_LEGACY_FLAGS - 1] in the order of
+// enum CfgItem (1: on), the SFR values at CFG_LEGACY_SFR_OFFSET + SFR address (all bytes 0xFF: not persisted),
+// 8 bit registers as bytes, the 16 bit registers as words, low byte first
+#define CFG_LEGACY_FLAGS        4
+#define CFG_LEGACY_SFR_OFFSET   0x300
+
+/****************************************************/
+// LOCAL STRUCT DEFINITION
+/****************************************************/
+
+// Declaration of the configuration struct
+struct Config
+{
+    uint8_t values[CFG_ITEMS_COUNT];    // RAM mirror of the configuration items
+    uint8_t dirty[CFG_ITEMS_COUNT];     // 1 if the item has not been handed over to the journal yet
+    uint8_t dirtyCount;                 // number of items to be handed over
+};
+
+/****************************************************/
+// LOCAL STATIC STRUCT VARIABLE DECLARATION, INIT
+/****************************************************/
+
+static struct Config this;
+
+// Default values of all configuration items
+static const uint8_t cfgDefaults[CFG_ITEMS_COUNT] PROGMEM =
+{
+    [CFG_ECHO_ALL_COMMANDS] = 0,
+    [CFG_COMMAND_HISTORY]   = 0,
+    [CFG_COMMAND_DETAILS]   = 0,
+    [CFG_STATUS_BAR]        = 0,
+    [CFG_STATUS_ROWS]       = 0,    // terminal rows of the status bar scroll region, 0 disables it
+};
+
+/****************************************************/
+// LOCAL MACROS
+/****************************************************/
+
+/****************************************************/
+// LOCAL FUNCTIONS
+/****************************************************/
+
+// Check whether the legacy layout stored the SFR at address as word: TCNT1, ICR1, OCR1A, OCR1B and UBRR0
+static uint8_t isLegacyWord(uint8_t address)
+{
+    return address == 0xC4 || (address >= 0x84 && address <= 0x8A && !(address & 1));
+}
+
+// Store a value in the journal, waits for free queue entries
+// Return value:    1: value stored
+//                  0: journal full
+static uint8_t storeValue(uint8_t type, uint8_t key, uint16_t value)
+{
+    uint8_t result;
+
+    while ((result = journalWrite(type, key, value)) == JOURNAL_BUSY)
+        HAL_BUSY_WAIT();
+    return result == JOURNAL_OK;
+}
+
+/****************************************************/
+// GLOBAL FUNCTIONS
+/****************************************************/
+
+// Import the flags and persisted SFR values of the EEPROM layout used before the journal, call once before
+// journalInit() at startup. Nothing is done if the journal has been formatted, values not fitting into it are dropped
+// Return value: number of values imported
+uint8_t cfgMigrate()
+{
+    uint8_t flags[CFG_LEGACY_FLAGS];
+    struct JournalEntry sfrs[JOURNAL_ENTRIES_MAX];  // no more SFR values fit into the journal
+    struct JournalEntry *sfr;
+    uint8_t sfrCount = 0;
+    uint8_t count = 0;
+
+    if (journalIsFormatted())
+        return 0;
+
+    // all values are read before journalInit() formats the first bank, which holds the flags
+    // and on an EEPROM larger than 1 KB the SFR values as well
+    for (uint8_t item = 0; item < CFG_LEGACY_FLAGS; item++)
+        flags[item] = eeqReadByte(item) == 1;
+    for (uint16_t address = 0; address <= 0xFF && sfrCount < JOURNAL_ENTRIES_MAX; address++)
+    {
+        sfr = &sfrs[sfrCount];
+        sfr->key = address;
+        if (isLegacyWord(address))
+        {
+            sfr->type = JOURNAL_TYPE_SFR16;
+            sfr->value = eeqReadWord(CFG_LEGACY_SFR_OFFSET + address++);
+            sfrCount += sfr->value != 0xFFFF;
+        }
+        else
+        {
+            sfr->type = JOURNAL_TYPE_SFR;
+            sfr->value = eeqReadByte(CFG_LEGACY_SFR_OFFSET + address);
+            sfrCount += sfr->value != 0xFF;
+        }
+    }
+
+    journalInit();
+    storeValue(JOURNAL_TYPE_SETTING, CFG_VERSION_KEY, CFG_VERSION);
+    for (uint8_t item = 0; item < CFG_LEGACY_FLAGS; item++)
+        if (flags[item])
+            count += storeValue(JOURNAL_TYPE_SETTING, item, 1);
+    for (uint8_t i = 0; i < sfrCount; i++)
+        count += storeValue(sfrs[i].type, sfrs[i].key, sfrs[i].value);
+
+    #if CFG_LEGACY_SFR_OFFSET >= JOURNAL_BANK_SIZE
+    // SFR values behind the first bank are cleared once imported, as the command history overlaps them
+    while (!eeqFill(CFG_LEGACY_SFR_OFFSET, E2END + 1 - CFG_LEGACY_SFR_OFFSET, 0xFF))
+        HAL_BUSY_WAIT();
+    #endif
+    eeqFlush();
+    return count;
+}
+
+// Load the configuration from the journal into RAM, call journalInit() before
+// Defaults are used for items never written and if the stored version does not match
+// Return value:    1: configuration loaded from the journal
+//                  0: stored version did not match, defaults loaded
+uint8_t cfgInit()
+{
+    const struct JournalEntry *entry = journalFind(JOURNAL_TYPE_SETTING, CFG_VERSION_KEY);
+    uint8_t result = 1;
+
+    memset(this.dirty, 0, CFG_ITEMS_COUNT);
+    this.dirtyCount = 0;
+
+    if (entry == NULL || entry->value != CFG_VERSION)
+    {
+        // drop all items stored with a different meaning and store the current version
+        journalErase(JOURNAL_TYPE_SETTING);
+        storeValue(JOURNAL_TYPE_SETTING, CFG_VERSION_KEY, CFG_VERSION);
+        result = 0;
+    }
+
+    for (uint8_t item = 0; item < CFG_ITEMS_COUNT; item++)
+    {
+        entry = journalFind(JOURNAL_TYPE_SETTING, item);
+        this.values[item] = entry != NULL ? (uint8_t) entry->value : pgm_read_byte(&cfgDefaults[item]);
+    }
+    return result;
+}
+
+// Get the value of a configuration item, 0 for invalid items
+uint8_t cfgGet(uint8_t item)
+{
+    if (item < CFG_ITEMS_COUNT)
+        return this.values[item];
+    return 0;
+}
+
+// Set the value of a configuration item in RAM, it is handed over to the journal by cfgService()
+// Return value:    1: value set
+//                  0: value set in RAM only, the journal has no entry left for the item, cfgService() retries
+uint8_t cfgSet(uint8_t item, uint8_t value)
+{
+    if (item >= CFG_ITEMS_COUNT)
+        return 1;
+    if (this.values[item] != value)
+    {
+        this.values[item] = value;
+        if (!this.dirty[item])
+        {
+            this.dirty[item] = 1;
+            this.dirtyCount++;
+        }
+    }
+    return journalFind(JOURNAL_TYPE_SETTING, item) != NULL || journalGetCount() < JOURNAL_ENTRIES_MAX;
+}
+
+// Hand over changed configuration items to the journal as long as the EEPROM write queue has free entries
+// Items not fitting into a full journal stay changed and are handed over once entries have been erased
+// Call cyclically from the main loop, never blocks unless the journal has to be compacted
+// Return value:    1: all changed items handed over or kept for a full journal
+//                  0: EEPROM write queue full, call again
+uint8_t cfgService()
+{
+    for (uint8_t item = 0; this.dirtyCount && item < CFG_ITEMS_COUNT; item++)
+        if (this.dirty[item])
+        {
+            switch (journalWrite(JOURNAL_TYPE_SETTING, item, this.values[item]))
+            {
+                case JOURNAL_BUSY:
+                    return 0;
+                case JOURNAL_FULL:
+                    break;
+                default:
+                    this.dirty[item] = 0;
+                    this.dirtyCount--;
+                    break;
+            }
+        }
+    return 1;
+}
+
+// Write back all changed configuration items to EEPROM, waits until all writes have completed
+// Return value: number of changed items not saved as the journal is full or the EEPROM is being cleared
+uint8_t cfgSave()
+{
+    while (!cfgService() && !journalIsSuspended())
+        HAL_BUSY_WAIT();
+    eeqFlush();
+    return this.dirtyCount;
+}
@@ -0,0 +1,260 @@
+/*
+ * File:            eeq.c
+ * Author:          Thomas Jerman
+ * Date Created:    18.10.2026
+ *
+ * Description:
+ * Providing an EEPROM write queue drained by ISR(EE_READY_vect)
+ */
+
+#include <stdio.h>
+
+#include <avr/eeprom.h>
+#include <avr/io.h>
+#include <avr/interrupt.h>
+#include <util/atomic.h>
+
+#include "eeq.h"
+#include "event.h"
+#include "hal.h"
+
+/****************************************************/
+// LOCAL DEFINES
+/****************************************************/
+
+#define EEQ_MASK        (EEQ_SIZE - 1)
+
+/****************************************************/
+// LOCAL STRUCT DEFINITION
+/****************************************************/
+
+// Queue entry: fill count bytes starting at address with value
+struct EeqEntry
+{
+    uint16_t address;                   // next EEPROM address to be written
+    uint16_t count;                     // remaining bytes of this entry
+    uint8_t value;                      // value to be written
+};
+
+// Declaration of the EEPROM queue struct
+struct Eeq
+{
+    struct EeqEntry entries[EEQ_SIZE];  // ring buffer of queue entries
+    volatile uint8_t head;              // next free entry, written by the main programme
+    volatile uint8_t tail;              // entry processed by the ISR
+    volatile uint16_t pending;          // bytes still to be processed
+    volatile uint16_t written;          // bytes written (not skipped) since startup
+    void (*doneCallback)(void);         // called by the ISR when the queue runs empty
+};
+
+/****************************************************/
+// LOCAL STATIC STRUCT VARIABLE DECLARATION, INIT
+/****************************************************/
+
+static struct Eeq this;
+
+/****************************************************/
+// LOCAL MACROS
+/****************************************************/
+
+/****************************************************/
+// LOCAL FUNCTIONS
+/****************************************************/
+
+// Get the number of free queue entries, call with interrupts disabled
+static uint8_t getFree()
+{
+    return EEQ_SIZE - (uint8_t) (this.head - this.tail);
+}
+
+// Add an entry to the queue and enable ISR(EE_READY_vect), call with interrupts disabled
+// and check for a free entry before
+static void push(uint16_t address, uint16_t count, uint8_t value)
+{
+    struct EeqEntry *entry = &this.entries[this.head & EEQ_MASK];
+    entry->address = address;
+    entry->count = count;
+    entry->value = value;
+    this.head++;
+    this.pending += count;
+    EECR |= (1 << EERIE);
+}
+
+/****************************************************/
+// GLOBAL FUNCTIONS
+/****************************************************/
+
+// Queue a byte to be written to EEPROM, bytes already holding the value are skipped
+// Return value:    1: byte queued
+//                  0: queue full, nothing queued
+uint8_t eeqWriteByte(uint16_t address, uint8_t value)
+{
+    return eeqFill(address, 1, value);
+}
+
+// Queue a word to be written to EEPROM (low byte first), both bytes or none are queued
+// Return value:    1: word queued
+//                  0: queue full, nothing queued
+uint8_t eeqWriteWord(uint16_t address, uint16_t value)
+{
+    uint8_t data[2] = {(uint8_t) value, (uint8_t) (value >> 8)};
+    return eeqWriteBlock(address, data, 2);
+}
+
+// Queue count bytes of src to be written to EEPROM starting at address, all bytes or none are queued
+// Each byte takes one queue entry, count must not exceed EEQ_SIZE
+// Return value:    1: bytes queued
+//                  0: queue full, nothing queued
+uint8_t eeqWriteBlock(uint16_t address, const void *src, uint8_t count)
+{
+    const uint8_t *data = (const uint8_t *) src;
+    uint8_t result = 0;
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+    {
+        if (getFree() >= count)
+        {
+            for (uint8_t i = 0; i < count; i++)
+                push(address + i, 1, data[i]);
+            result = 1;
+        }
+    }
+    return result;
+}
+
+// Queue count bytes starting at address to be filled with value, e.g. 0xFF to clear the EEPROM
+// Return value:    1: range queued
+//                  0: queue full, nothing queued
+uint8_t eeqFill(uint16_t address, uint16_t count, uint8_t value)
+{
+    uint8_t result = 0;
+    if (count == 0)
+        return 1;
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+    {
+        if (getFree() >= 1)
+        {
+            push(address, count, value);
+            result = 1;
+        }
+    }
+    return result;
+}
+
+// Read a byte from EEPROM, the value of a pending write is returned if address is queued
+// Never starts a read while the ISR writes to EEPROM
+uint8_t eeqReadByte(uint16_t address)
+{
+    while (1)
+    {
+        ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+        {
+            // the newest queued entry covering address holds the value to be returned
+            for (uint8_t i = this.head; i != this.tail; )
+            {
+                const struct EeqEntry *entry = &this.entries[--i & EEQ_MASK];
+                if ((uint16_t) (address - entry->address) < entry->count)
+                    return entry->value;
+            }
+            // the ISR starts no write while interrupts are disabled
+            if (eeprom_is_ready())
+                return eeprom_read_byte((const uint8_t *) (uintptr_t) address);
+        }
+    }
+}
+
+// Read a word from EEPROM (low byte first) using eeqReadByte()
+uint16_t eeqReadWord(uint16_t address)
+{
+    return eeqReadByte(address) | (eeqReadByte(address + 1) << 8);
+}
+
+// Read count bytes from EEPROM into dst using eeqReadByte()
+void eeqReadBlock(void *dst, uint16_t address, uint16_t count)
+{
+    uint8_t *data = (uint8_t *) dst;
+    while (count--)
+        *data++ = eeqReadByte(address++);
+}
+
+// Get the number of bytes still to be processed by the queue
+uint16_t eeqGetPending()
+{
+    uint16_t pending;
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+    {
+        pending = this.pending;
+    }
+    return pending;
+}
+
+// Get the number of bytes written (not skipped) since startup
+uint16_t eeqGetWritten()
+{
+    uint16_t written;
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+    {
+        written = this.written;
+    }
+    return written;
+}
+
+// Return value:    1: queue empty and no EEPROM write in progress
+//                  0: queue busy, EVENT_EEPROM is posted once it runs empty
+uint8_t eeqIsIdle()
+{
+    return this.head == this.tail && eeprom_is_ready();
+}
+
+// Set a function called from ISR(EE_READY_vect) each time the queue runs empty, NULL to disable
+// Keep it short, it is executed in interrupt context
+void eeqSetDoneCallback(void (*doneCallback)(void))
+{
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+    {
+        this.doneCallback = doneCallback;
+    }
+}
+
+// Wait until all queued bytes have been written to EEPROM
+void eeqFlush()
+{
+    // the ISR cannot drain the queue with interrupts disabled
+    if (!(SREG & (1 << SREG_I)))
+        return;
+    while (!eeqIsIdle())
+        HAL_BUSY_WAIT();
+}
+
+// Process queued bytes until one byte is written, the interrupt fires again as soon as
+// the write has completed. Unchanged bytes are skipped, at most EEQ_SKIPS_PER_ISR per call
+// EVENT_EEPROM is posted once the queue runs empty
+ISR(EE_READY_vect)
+{
+    for (uint8_t skips = 0; skips < EEQ_SKIPS_PER_ISR; skips++)
+    {
+        if (this.head == this.tail)
+        {
+            EECR &= ~(1 << EERIE);
+            eventPost(EVENT_EEPROM, 0);
+            if (this.doneCallback != NULL)
+                this.doneCallback();
+            return;
+        }
+
+        struct EeqEntry *entry = &this.entries[this.tail & EEQ_MASK];
+        uint8_t *address = (uint8_t *) (uintptr_t) entry->address;
+        uint8_t value = entry->value;
+        entry->address++;
+        this.pending--;
+        if (--entry->count == 0)
+            this.tail++;
+
+        if (eeprom_read_byte(address) != value)
+        {
+            // EEPE is cleared, eeprom_write_byte() starts the write and returns immediately
+            eeprom_write_byte(address, value);
+            this.written++;
+            return;
+        }
+    }
+}
@@ -0,0 +1,137 @@
+/*
+ * File:            event.c
+ * Author:          Thomas Jerman
+ * Date Created:    18.10.2026
+ *
+ * Description:
+ * Providing a lock-free single-producer/single-consumer event queue from the ISRs to the main loop
+ */
+
+#include <stdio.h>
+
+#include <avr/io.h>
+#include <avr/interrupt.h>
+#include <util/atomic.h>
+
+#include "clock.h"
+#include "event.h"
+#include "idle.h"
+
+/****************************************************/
+// LOCAL DEFINES
+/****************************************************/
+
+#define EVENT_MASK      (EVENT_QUEUE_SIZE - 1)
+
+/****************************************************/
+// LOCAL STRUCT DEFINITION
+/****************************************************/
+
+// Declaration of the event queue struct, head and tail run freely and are masked on access
+struct EventQueue
+{
+    struct Event events[EVENT_QUEUE_SIZE];
+    volatile uint8_t head;              // next free event, written by the producer only
+    volatile uint8_t tail;              // next event to be taken, written by the consumer only
+    volatile uint8_t overflow;          // set by the producer on a full queue
+    volatile uint16_t dropped;          // events lost since startup
+};
+
+/****************************************************/
+// LOCAL STATIC STRUCT VARIABLE DECLARATION, INIT
+/****************************************************/
+
+static struct EventQueue this;
+
+/****************************************************/
+// LOCAL MACROS
+/****************************************************/
+
+// Keep the compiler from moving event accesses across head and tail updates
+#define MEMORY_BARRIER()    __asm__ __volatile__ ("" ::: "memory")
+
+/****************************************************/
+// LOCAL FUNCTIONS
+/****************************************************/
+
+// Check for an empty queue without lost events, called by idleSleep() with interrupts disabled
+static uint8_t isEmpty()
+{
+    return this.tail == this.head && !this.overflow;
+}
+
+/****************************************************/
+// GLOBAL FUNCTIONS
+/****************************************************/
+
+// Post an event, call within an ISR or with interrupts disabled
+// Return value:    1: event posted
+//                  0: queue full, event lost and reported as EVENT_OVERFLOW
+uint8_t eventPost(uint8_t type, uint8_t data)
+{
+    uint8_t head = this.head;
+    struct Event *event;
+
+    if ((uint8_t) (head - this.tail) >= EVENT_QUEUE_SIZE)
+    {
+        this.overflow = 1;
+        if (this.dropped != 0xFFFF)
+            this.dropped++;
+        return 0;
+    }
+    event = &this.events[head & EVENT_MASK];
+    event->type = type;
+    event->data = data;
+    event->time = (uint16_t) clockMillis();
+    MEMORY_BARRIER();
+    this.head = head + 1;
+    return 1;
+}
+
+// Take the next event, EVENT_OVERFLOW first if events were lost
+// Return value:    1: event copied to event
+//                  0: no event
+uint8_t eventGet(struct Event *event)
+{
+    uint8_t tail = this.tail;
+
+    if (this.overflow)
+    {
+        ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+            this.overflow = 0;
+        event->type = EVENT_OVERFLOW;
+        event->data = 0;
+        event->time = (uint16_t) clockMillis();
+        return 1;
+    }
+    if (tail == this.head)
+        return 0;
+    MEMORY_BARRIER();
+    *event = this.events[tail & EVENT_MASK];
+    MEMORY_BARRIER();
+    this.tail = tail + 1;
+    return 1;
+}
+
+// Wait for the next event, the CPU sleeps in SLEEP_MODE_IDLE while the queue is empty
+// Call with interrupts enabled from the main loop only
+void eventWait(struct Event *event)
+{
+    while (!eventGet(event))
+        idleSleep(isEmpty);
+}
+
+// Get the number of events waiting in the queue
+uint8_t eventGetPending()
+{
+    return (uint8_t) (this.head - this.tail);
+}
+
+// Get the number of events lost since startup
+uint16_t eventGetDropped()
+{
+    uint16_t dropped;
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+        dropped = this.dropped;
+    return dropped;
+}
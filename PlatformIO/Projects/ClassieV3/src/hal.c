@@ -0,0 +1,43 @@
+/*
+ * File:            hal.c
+ * Author:          Thomas Jerman
+ * Date Created:    18.10.2026
+ *
+ * Description:
+ * Providing the hardware abstraction used by the Classie modules
+ */
+
+#include <stdio.h>
+
+#include <avr/io.h>
+
+#include "hal.h"
+
+/****************************************************/
+// LOCAL DEFINES
+/****************************************************/
+
+/****************************************************/
+// LOCAL STRUCT DEFINITION
+/****************************************************/
+
+/****************************************************/
+// GLOBAL STRUCT VARIABLE DECLARATION, INIT
+/****************************************************/
+
+#ifndef CLASSIE_NATIVE
+// The single stream stdout is connected to, HAL_STDOUT_INIT() only exchanges its output function
+FILE halStdout;
+#endif
+
+/****************************************************/
+// LOCAL MACROS
+/****************************************************/
+
+/****************************************************/
+// LOCAL FUNCTIONS
+/****************************************************/
+
+/****************************************************/
+// GLOBAL FUNCTIONS
+/****************************************************/
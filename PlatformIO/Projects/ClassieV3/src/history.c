@@ -0,0 +1,182 @@
+/*
+ * File:            history.c
+ * Author:          Thomas Jerman
+ * Date Created:    18.10.2026
+ *
+ * Description:
+ * Providing persistence of the newest commands of the CLI history in EEPROM
+ */
+
+#include <stdio.h>
+
+#include <avr/io.h>
+#include <util/crc16.h>
+
+#include "cli.h"
+#include "eeq.h"
+#include "hal.h"
+#include "history.h"
+#include "journal.h"
+
+/****************************************************/
+// LOCAL DEFINES
+/****************************************************/
+
+// Layout of the history area: magic, number of commands, per command its length followed by
+// its characters, oldest first, and the CRC-8 of all preceding bytes
+#define HIST_MAGIC          0x48
+#define HIST_OVERHEAD       3       // magic, number of commands and CRC-8
+
+/****************************************************/
+// LOCAL STRUCT DEFINITION
+/****************************************************/
+
+// Declaration of the history struct
+struct History
+{
+    uint8_t savedChanges;               // cliGetHistoryChanges() of the history loaded or saved last
+    uint8_t first;                      // oldest command being saved
+    uint8_t size;                       // bytes of the image being saved
+};
+
+/****************************************************/
+// LOCAL STATIC STRUCT VARIABLE DECLARATION, INIT
+/****************************************************/
+
+static struct History this;
+
+/****************************************************/
+// LOCAL MACROS
+/****************************************************/
+
+/****************************************************/
+// LOCAL FUNCTIONS
+/****************************************************/
+
+// Select the newest commands fitting into the history area, sets this.first and this.size
+static void selectCommands()
+{
+    uint8_t count = cliGetHistoryCount();
+    uint8_t length;
+
+    this.first = count;
+    this.size = HIST_OVERHEAD;
+    while (this.first > 0 && count - this.first < HIST_PERSIST_COUNT)
+    {
+        cliGetHistoryEntry(this.first - 1, &length);
+        if (this.size + 1 + length > HIST_EEPROM_SIZE)
+            break;
+        this.size += 1 + length;
+        this.first--;
+    }
+}
+
+// Get the byte at position of the image of the commands selected, except the CRC-8
+static uint8_t getImageByte(uint8_t position)
+{
+    const char *command;
+    uint8_t length;
+
+    if (position == 0)
+        return HIST_MAGIC;
+    if (position == 1)
+        return cliGetHistoryCount() - this.first;
+    position -= 2;
+    for (uint8_t index = this.first; index < cliGetHistoryCount(); index++)
+    {
+        command = cliGetHistoryEntry(index, &length);
+        if (position == 0)
+            return length;
+        if (position <= length)
+            return command[position - 1];
+        position -= 1 + length;
+    }
+    return 0;
+}
+
+// Load the saved commands into the history of the CLI instance selected
+// Return value: number of commands loaded, 0 if none were saved or the history area is corrupted
+static uint8_t loadCommands()
+{
+    char command[REC_CHAR_MAX];
+    uint16_t address = HIST_EEPROM_ADDRESS + 2;
+    uint16_t end = HIST_EEPROM_ADDRESS + HIST_EEPROM_SIZE - 1;
+    uint8_t count, length, crc = 0;
+
+    this.savedChanges = cliGetHistoryChanges();
+    if (HIST_PERSIST_COUNT == 0 || eeqReadByte(HIST_EEPROM_ADDRESS) != HIST_MAGIC)
+        return 0;
+
+    // check the lengths and the CRC-8 before touching the CLI history
+    count = eeqReadByte(HIST_EEPROM_ADDRESS + 1);
+    for (uint8_t index = 0; index < count; index++)
+    {
+        length = eeqReadByte(address);
+        if (length == 0 || length > REC_CHAR_MAX || address + 1 + length > end)
+            return 0;
+        address += 1 + length;
+    }
+    for (uint16_t i = HIST_EEPROM_ADDRESS; i < address; i++)
+        crc = _crc8_ccitt_update(crc, eeqReadByte(i));
+    if (crc != eeqReadByte(address))
+        return 0;
+
+    address = HIST_EEPROM_ADDRESS + 2;
+    for (uint8_t index = 0; index < count; index++)
+    {
+        length = eeqReadByte(address);
+        eeqReadBlock(command, address + 1, length);
+        cliAddHistoryEntry(command, length);
+        address += 1 + length;
+    }
+    // the history loaded is saved already
+    this.savedChanges = cliGetHistoryChanges();
+    return count;
+}
+
+// Write back the newest commands of the CLI instance selected if its history changed since it was loaded or saved
+static void saveCommands()
+{
+    uint8_t value, crc = 0;
+
+    if (HIST_PERSIST_COUNT == 0 || journalIsSuspended() || this.savedChanges == cliGetHistoryChanges())
+        return;
+    selectCommands();
+    for (uint8_t position = 0; position < this.size; position++)
+    {
+        value = position + 1 < this.size ? getImageByte(position) : crc;
+        while (!eeqWriteByte(HIST_EEPROM_ADDRESS + position, value))
+            HAL_BUSY_WAIT();
+        crc = _crc8_ccitt_update(crc, value);
+    }
+    this.savedChanges = cliGetHistoryChanges();
+    eeqFlush();
+}
+
+/****************************************************/
+// GLOBAL FUNCTIONS
+/****************************************************/
+
+// Load the saved commands into the history of the console, CLI instance 0, call cliInit() before
+// Return value: number of commands loaded, 0 if none were saved or the history area is corrupted
+uint8_t histLoad()
+{
+    uint8_t selected = cliGetInstance();
+    uint8_t count;
+
+    cliSelect(0);
+    count = loadCommands();
+    cliSelect(selected);
+    return count;
+}
+
+// Write back the newest commands of the console, CLI instance 0, to EEPROM if its history changed since it was
+// loaded or saved, waits until all writes have completed. Nothing is saved while the EEPROM is cleared
+void histSave()
+{
+    uint8_t selected = cliGetInstance();
+
+    cliSelect(0);
+    saveCommands();
+    cliSelect(selected);
+}
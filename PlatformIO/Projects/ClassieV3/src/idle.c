@@ -0,0 +1,103 @@
+/*
+ * File:            idle.c
+ * Author:          Thomas Jerman
+ * Date Created:    18.10.2026
+ *
+ * Description:
+ * Providing idle sleep of the main loop and the CPU load
+ */
+
+#include <stdio.h>
+
+#include <avr/io.h>
+#include <avr/interrupt.h>
+#include <avr/sleep.h>
+
+#include "clock.h"
+#include "idle.h"
+
+/****************************************************/
+// LOCAL DEFINES
+/****************************************************/
+
+/****************************************************/
+// LOCAL STRUCT DEFINITION
+/****************************************************/
+
+// Declaration of the idle struct, used by the main loop only
+struct Idle
+{
+    uint32_t windowStart;               // clockMicros() at the start of the current window
+    uint32_t slept;                     // microseconds slept within the current window
+    uint8_t load;                       // CPU load of the last completed window in percent
+};
+
+/****************************************************/
+// LOCAL STATIC STRUCT VARIABLE DECLARATION, INIT
+/****************************************************/
+
+static struct Idle this;
+
+/****************************************************/
+// LOCAL MACROS
+/****************************************************/
+
+/****************************************************/
+// LOCAL FUNCTIONS
+/****************************************************/
+
+// Complete the current window if IDLE_WINDOW_US have passed
+static void updateLoad(uint32_t now)
+{
+    uint32_t elapsed = now - this.windowStart;
+    if (elapsed < IDLE_WINDOW_US)
+        return;
+    if (this.slept > elapsed)
+        this.slept = elapsed;
+    this.load = 100 - (uint8_t) (this.slept * 100 / elapsed);
+    this.windowStart = now;
+    this.slept = 0;
+}
+
+/****************************************************/
+// GLOBAL FUNCTIONS
+/****************************************************/
+
+// Sleep in SLEEP_MODE_IDLE until the next interrupt if isIdle() returns 1
+// isIdle() is called with interrupts disabled and checks that no module has pending work
+// Call with interrupts enabled from the main loop only
+void idleSleep(uint8_t (*isIdle)())
+{
+    uint32_t sleepStart, wake, frameStart;
+
+    set_sleep_mode(SLEEP_MODE_IDLE);
+    sleepStart = clockMicros();
+
+    // an ISR posting work between the check and sleep_cpu() would be missed:
+    // check with interrupts disabled, the instruction following sei() is always executed
+    cli();
+    if (!isIdle())
+    {
+        sei();
+        return;
+    }
+    sleep_enable();
+    sei();
+    sleep_cpu();
+    sleep_disable();
+
+    // woken by ISR(TIMER2_COMPA_vect) if a frame started while sleeping, its execution is busy time
+    wake = clockMicros();
+    frameStart = wake - (TCNT2 >> 1);
+    if ((int32_t) (frameStart - sleepStart) > 0)
+        wake = frameStart;
+    this.slept += wake - sleepStart;
+    updateLoad(wake);
+}
+
+// Get the CPU load in percent of the last completed measurement window
+uint8_t idleGetLoad()
+{
+    updateLoad(clockMicros());
+    return this.load;
+}
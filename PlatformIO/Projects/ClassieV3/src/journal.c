@@ -0,0 +1,313 @@
+/*
+ * File:            journal.c
+ * Author:          Thomas Jerman
+ * Date Created:    18.10.2026
+ *
+ * Description:
+ * Providing a wear-leveled key/value journal in EEPROM with a RAM index
+ */
+
+#include <stdio.h>
+
+#include <avr/io.h>
+#include <util/crc16.h>
+
+#include "eeq.h"
+#include "hal.h"
+#include "journal.h"
+
+/****************************************************/
+// LOCAL DEFINES
+/****************************************************/
+
+#define JOURNAL_MAGIC       0x4A
+#define JOURNAL_EMPTY       0xFF    // type of an erased record, marks the end of the journal
+
+#define HEADER_SIZE         sizeof(struct JournalHeader)
+#define RECORD_SIZE         sizeof(struct JournalRecord)
+#define RECORDS_PER_BANK    ((JOURNAL_BANK_SIZE - HEADER_SIZE) / RECORD_SIZE)
+
+/****************************************************/
+// LOCAL STRUCT DEFINITION
+/****************************************************/
+
+// Bank header, written last when a bank becomes active
+struct JournalHeader
+{
+    uint8_t magic;                      // JOURNAL_MAGIC
+    uint8_t generation;                 // the valid bank with the newer generation is active
+    uint8_t crc;                        // CRC-8 of magic and generation
+};
+
+// Record as stored in EEPROM
+struct JournalRecord
+{
+    uint8_t type;                       // JOURNAL_TYPE_..., JOURNAL_EMPTY if not written yet
+    uint8_t key;                        // key within the name space of type
+    uint8_t valueLow;                   // low byte of value
+    uint8_t valueHigh;                  // high byte of value
+    uint8_t crc;                        // CRC-8 of type, key and value
+};
+
+// Declaration of the journal struct
+struct Journal
+{
+    struct JournalEntry entries[JOURNAL_ENTRIES_MAX];   // RAM index of live entries
+    uint8_t count;                      // number of live entries
+    uint8_t bank;                       // active bank: 0 or 1
+    uint8_t generation;                 // generation of the active bank
+    uint16_t writeAddress;              // EEPROM address of the next record to be appended
+    uint8_t suspended;                  // 1 while the EEPROM is cleared, no records are written until journalInit()
+};
+
+/****************************************************/
+// LOCAL STATIC STRUCT VARIABLE DECLARATION, INIT
+/****************************************************/
+
+static struct Journal this;
+
+/****************************************************/
+// LOCAL MACROS
+/****************************************************/
+
+/****************************************************/
+// LOCAL FUNCTIONS
+/****************************************************/
+
+// Calculate CRC-8 of length bytes
+static uint8_t calculateCrc(const void *data, uint8_t length)
+{
+    const uint8_t *bytes = (const uint8_t *) data;
+    uint8_t crc = 0;
+    while (length--)
+        crc = _crc8_ccitt_update(crc, *bytes++);
+    return crc;
+}
+
+// Get the EEPROM address of the first byte of a bank
+static uint16_t getBankAddress(uint8_t bank)
+{
+    return bank * JOURNAL_BANK_SIZE;
+}
+
+// Get the EEPROM address behind the last record of the active bank
+static uint16_t getBankEnd()
+{
+    return getBankAddress(this.bank) + HEADER_SIZE + RECORDS_PER_BANK * RECORD_SIZE;
+}
+
+// Read the header of a bank
+// Return value:    1: header valid, generation set
+//                  0: bank not formatted
+static uint8_t readHeader(uint8_t bank, uint8_t *generation)
+{
+    struct JournalHeader header;
+    eeqReadBlock(&header, getBankAddress(bank), HEADER_SIZE);
+    *generation = header.generation;
+    return header.magic == JOURNAL_MAGIC && header.crc == calculateCrc(&header, HEADER_SIZE - 1);
+}
+
+// Find the live entry of key within the name space of type
+static struct JournalEntry *findEntry(uint8_t type, uint8_t key)
+{
+    for (uint8_t i = 0; i < this.count; i++)
+        if ((this.entries[i].type & JOURNAL_TYPE_MASK) == (type & JOURNAL_TYPE_MASK) && this.entries[i].key == key)
+            return &this.entries[i];
+    return NULL;
+}
+
+// Update an entry or add a new one if entry is NULL, check for a free entry before
+static void setEntry(struct JournalEntry *entry, uint8_t type, uint8_t key, uint16_t value)
+{
+    if (entry == NULL)
+        entry = &this.entries[this.count++];
+    entry->type = type;
+    entry->key = key;
+    entry->value = value;
+}
+
+// Fill a record from type, key and value
+static void makeRecord(struct JournalRecord *record, uint8_t type, uint8_t key, uint16_t value)
+{
+    record->type = type;
+    record->key = key;
+    record->valueLow = (uint8_t) value;
+    record->valueHigh = (uint8_t) (value >> 8);
+    record->crc = calculateCrc(record, RECORD_SIZE - 1);
+}
+
+// Queue bytes to be written to EEPROM, waits for free queue entries
+static void writeBlock(uint16_t address, const void *src, uint8_t count)
+{
+    while (!eeqWriteBlock(address, src, count))
+        HAL_BUSY_WAIT();
+}
+
+// Erase a bank, write all live entries to it and activate it by writing its header last,
+// the previously active bank stays valid until the new header has been written
+static void activateBank(uint8_t bank, uint8_t generation)
+{
+    struct JournalHeader header = {JOURNAL_MAGIC, generation, 0};
+    struct JournalRecord record;
+    uint16_t address = getBankAddress(bank);
+
+    while (!eeqFill(address, JOURNAL_BANK_SIZE, 0xFF))
+        HAL_BUSY_WAIT();
+    address += HEADER_SIZE;
+    for (uint8_t i = 0; i < this.count; i++)
+    {
+        makeRecord(&record, this.entries[i].type, this.entries[i].key, this.entries[i].value);
+        writeBlock(address, &record, RECORD_SIZE);
+        address += RECORD_SIZE;
+    }
+    header.crc = calculateCrc(&header, HEADER_SIZE - 1);
+    writeBlock(getBankAddress(bank), &header, HEADER_SIZE);
+
+    this.bank = bank;
+    this.generation = generation;
+    this.writeAddress = address;
+}
+
+/****************************************************/
+// GLOBAL FUNCTIONS
+/****************************************************/
+
+// Build the RAM index by one sequential scan of the active bank
+// A bank is formatted if none holds a valid header, e.g. after clearing the EEPROM
+// Return value: number of live entries
+uint8_t journalInit()
+{
+    struct JournalRecord record;
+    uint8_t generation[2];
+    uint8_t valid0 = readHeader(0, &generation[0]);
+    uint8_t valid1 = readHeader(1, &generation[1]);
+    uint16_t address;
+
+    this.count = 0;
+    this.suspended = 0;
+    if (!valid0 && !valid1)
+    {
+        activateBank(0, 0);
+        return 0;
+    }
+
+    // the generation counter wraps around, so compare the signed difference
+    this.bank = valid1 && (!valid0 || (int8_t) (generation[1] - generation[0]) > 0);
+    this.generation = generation[this.bank];
+
+    // later records overwrite earlier ones, records with a CRC error are skipped
+    for (address = getBankAddress(this.bank) + HEADER_SIZE; address < getBankEnd(); address += RECORD_SIZE)
+    {
+        eeqReadBlock(&record, address, RECORD_SIZE);
+        if (record.type == JOURNAL_EMPTY)
+            break;
+        if (record.crc == calculateCrc(&record, RECORD_SIZE - 1))
+        {
+            struct JournalEntry *entry = findEntry(record.type, record.key);
+            if (entry != NULL || this.count < JOURNAL_ENTRIES_MAX)
+                setEntry(entry, record.type, record.key, record.valueLow | (record.valueHigh << 8));
+        }
+    }
+    this.writeAddress = address;
+    return this.count;
+}
+
+// Check whether the EEPROM holds a journal, e.g. to import the layout of an older firmware before journalInit()
+// Return value:    1: a bank holds a valid header
+//                  0: no bank formatted
+uint8_t journalIsFormatted()
+{
+    uint8_t generation;
+
+    return readHeader(0, &generation) || readHeader(1, &generation);
+}
+
+// Find the live entry of key within the name space of type
+// Return value: NULL if key has never been written
+const struct JournalEntry *journalFind(uint8_t type, uint8_t key)
+{
+    return findEntry(type, key);
+}
+
+// Append a record to the journal unless the entry already holds value
+// Compacts the journal into the other bank if the active bank is full, waiting for free queue entries then
+// Return value: JOURNAL_OK, JOURNAL_BUSY or JOURNAL_FULL
+uint8_t journalWrite(uint8_t type, uint8_t key, uint16_t value)
+{
+    struct JournalEntry *entry = findEntry(type, key);
+    struct JournalRecord record;
+
+    if (entry != NULL && entry->type == type && entry->value == value)
+        return JOURNAL_OK;
+    if (this.suspended)
+        return JOURNAL_BUSY;
+    if (entry == NULL && this.count == JOURNAL_ENTRIES_MAX)
+        return JOURNAL_FULL;
+
+    if (this.writeAddress + RECORD_SIZE > getBankEnd())
+    {
+        setEntry(entry, type, key, value);
+        activateBank(this.bank ^ 1, this.generation + 1);
+        return JOURNAL_OK;
+    }
+
+    makeRecord(&record, type, key, value);
+    if (!eeqWriteBlock(this.writeAddress, &record, RECORD_SIZE))
+        return JOURNAL_BUSY;
+    this.writeAddress += RECORD_SIZE;
+    setEntry(entry, type, key, value);
+    return JOURNAL_OK;
+}
+
+// Remove all entries within the name space of type and compact the journal
+void journalErase(uint8_t type)
+{
+    uint8_t count = 0;
+    for (uint8_t i = 0; i < this.count; i++)
+        if ((this.entries[i].type & JOURNAL_TYPE_MASK) != (type & JOURNAL_TYPE_MASK))
+            this.entries[count++] = this.entries[i];
+    // the EEPROM being cleared holds no entries once journalInit() rescans it
+    if (count != this.count)
+    {
+        this.count = count;
+        if (!this.suspended)
+            activateBank(this.bank ^ 1, this.generation + 1);
+    }
+}
+
+// Suspend writing to EEPROM while it is cleared, journalWrite() returns JOURNAL_BUSY until journalInit()
+void journalSuspend()
+{
+    this.suspended = 1;
+}
+
+// Return value:    1: writing suspended by journalSuspend() until journalInit()
+//                  0: records are written
+uint8_t journalIsSuspended()
+{
+    return this.suspended;
+}
+
+// Get the number of live entries
+uint8_t journalGetCount()
+{
+    return this.count;
+}
+
+// Get a live entry by index in the range [0, journalGetCount() - 1]
+const struct JournalEntry *journalGetEntry(uint8_t index)
+{
+    return index < this.count ? &this.entries[index] : NULL;
+}
+
+// Get the number of records which can be appended until the journal is compacted
+uint16_t journalGetFree()
+{
+    return (getBankEnd() - this.writeAddress) / RECORD_SIZE;
+}
+
+// Get the generation of the active bank, incremented on each compaction
+uint8_t journalGetGeneration()
+{
+    return this.generation;
+}
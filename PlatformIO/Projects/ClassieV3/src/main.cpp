@@ -15,122 +15,158 @@
 #include <avr/pgmspace.h>
 #include <util/delay.h>
 
+#include "appcmd.h"
 #include "cli.h"
 #include "cmd.h"
+#include "config.h"
+#include "event.h"
+#include "history.h"
+#include "idle.h"
+#include "journal.h"
 #include "nec.h"
+#include "proto.h"
+#include "sched.h"
 #include "timer2.h"
 #include "sfr328p.h"
 #include "statusbar.h"
 
 #define STANDARD_PROMPT     "AVR>"
 #define SUPERUSER_PROMPT    "SU@AVR>"
+#define CLI_BPS             76800   // bitrate of all CLI instances
+
+// LED on Arduino pin 13
+#if defined(__AVR_ATmega2560__)
+#define LED_BIT             PB7
+#else
+#define LED_BIT             PB5
+#endif
+
+// Hard task every millisecond: counting seconds and blinking the LED on LED_BIT of PORTB
+static void secondsTask()
+{
+    static unsigned int milliSecondCounter = 0;
+
+    if (milliSecondCounter == 1000)
+    {
+        PORTB &= ~(1 << LED_BIT);
+        timer2IncrementSeconds();
+        eventPost(EVENT_SECOND, (uint8_t) timer2GetSeconds());
+        milliSecondCounter = 0;
+    }
+    if (milliSecondCounter == 250)
+        PORTB |= (1 << LED_BIT);
+    milliSecondCounter++;
+}
+
+// Print the UART prompt of the user logged in
+static void printPrompt(uint8_t logged_in)
+{
+    if (logged_in)
+        cliPrintPrompt(TXT_BOLD TXT_GREEN, SUPERUSER_PROMPT, MAIN_LEVEL);   // Print UART prompt to show, that the ISR-driven UART interface is available
+    else
+        cliPrintPrompt(TXT_GREEN, STANDARD_PROMPT, MAIN_LEVEL);    // Print UART prompt to show, that the ISR-driven UART interface is available
+}
 
 // main-Function
 int main()
 {
-    uint8_t logged_in = 0;
-    uint32_t seconds = 1;
+    uint8_t logged_in[CLI_INSTANCES] = {0};    // login status of each CLI instance
+    uint8_t pollAll = 0;
+    struct Event event;
 
     // CLI INITIALISATION
-	cliInit(76800);                 // Initialize UART
-    cliSetStatusBar(statusBar);     // Set application's status bar print function
-    cmdUpdateAllSfrFromEEPROM();    // Update all SFRs with values stored in EEPROM
+	cliInit(CLI_BPS);               // Initialize UART
+    #if CLI_INSTANCES > 1
+    for (uint8_t instance = 1; instance < CLI_INSTANCES; instance++)
+        cliInitInstance(instance, instance, CLI_BPS);   // Further shells bound to USART1 and up, e.g. a machine-control port
+    cliSelect(0);                   // Instance 0 is the console showing the status bar and saving its history
+    #endif
+    cfgMigrate();                   // Import the settings stored by firmware before the EEPROM journal once
+    journalInit();                  // Build the RAM index of the EEPROM journal
+    cfgInit();                      // Load configuration from the journal into RAM
+    histLoad();                     // Load the commands saved in EEPROM into the command history
+    statusBarRegister();            // Set application's status bar fields
+    cliSetStatusScrollRegion(cfgGet(CFG_STATUS_ROWS)); // Reserve the status bar rows if terminal rows are configured
+    appCmdRegister();               // Register application's command table
 
     // WELCOME TEXT
-	printf_P(PSTR(CLEAR_SCREEN TXT_RESET_FORMAT TXT_GREEN "Robotic Nano Command Line Interface" TXT_RESET_FORMAT "\n"));
+	printf_P(PSTR(RESET_SCROLL_REGION CLEAR_SCREEN TXT_RESET_FORMAT TXT_GREEN "Robotic Nano Command Line Interface" TXT_RESET_FORMAT "\n"));
     printf_P(PSTR("Compiled on " __DATE__ " at " __TIME__ "\n"));
     printf_P(PSTR("Press Ctrl+D or enter \"dc\" to list " TXT_UNDERLINED "d" TXT_RESET_FORMAT "efault " TXT_UNDERLINED "c" TXT_RESET_FORMAT "ommands\n"));
 
     // CONTROLLER INITIALISATION
-    timer2CTCInit();                // Timer2 init with a cycle time of 125 us used for task execution within its ISR(TIMER2_COMPA_vect)
-    cmdUpdateAllSfrFromEEPROM();    // Update all SFR with values stored in EEPROM
+    schedAddTask(secondsTask, SCHED_FRAMES_PER_MS, 0, SCHED_HARD); // Count seconds within ISR(TIMER2_COMPA_vect)
+    timer2CTCInit();                // Timer2 init with a cycle time of 125 us used for task execution by the scheduler
+    cmdUpdateAllSfrFromEEPROM(CMD_SFR_VERBOSE); // Update all SFRs persisted in EEPROM, once all peripherals are initialized
         
     // SYSTEM PROMPT
-    cmdExecuteCommand(&logged_in);  // Call cmdExecuteCommand to load printStatusBarFlag
+    cmdExecuteCommand(&logged_in[0]);   // Call cmdExecuteCommand to load printStatusBarFlag
     cliPrintPrompt(TXT_GREEN, STANDARD_PROMPT, 0); // Print UART prompt to show, that the ISR-driven UART interface is available
+    #if CLI_INSTANCES > 1
+    for (uint8_t instance = 1; instance < CLI_INSTANCES; instance++)
+    {
+        cliSelect(instance);
+        cliPrintPrompt(TXT_GREEN, STANDARD_PROMPT, 0);
+    }
+    cliSelect(0);
+    #endif
 
     necStartReceiving();
 
-    DDRB |= (1 << PB5);
+    DDRB |= (1 << LED_BIT);
   
 	while (1)
 	{  
-        if (cliProcessRxData())     // If cliProcessRxData() returns 1, a received command line can be processed
-		{
-			cmdExecuteCommand(&logged_in);   // Executes all CLI-commands
+        eventWait(&event);          // Sleep until an ISR posts an event, nothing to do before
+        pollAll = (event.type == EVENT_OVERFLOW);   // Events were lost, poll all event sources
 
-			if (logged_in)
-				cliPrintPrompt(TXT_BOLD TXT_GREEN, SUPERUSER_PROMPT, MAIN_LEVEL);   // Print UART prompt to show, that the ISR-driven UART interface is available
-			else
-				cliPrintPrompt(TXT_GREEN, STANDARD_PROMPT, MAIN_LEVEL);    // Print UART prompt to show, that the ISR-driven UART interface is available
-		}
-
-        if (necProcessRxData() == 1)     // if necProcessRxData() return 1, a received IR-command can be processed
+        if (pollAll || event.type == EVENT_CLI_RX)
         {
-            printf("0x%0X%0X%0X%0X%0X", necGetProcessedRxData(0), necGetProcessedRxData(1),
-                necGetProcessedRxData(2), necGetProcessedRxData(3));
-            printf("\n");
-            necStartReceiving();
+            for (uint8_t instance = 0; instance < CLI_INSTANCES; instance++)
+            {
+                cliSelect(instance);        // Each CLI instance processes its own command lines
+                while (!cliIsBinaryMode() && cliGetRxPending())   // The binary protocol reads the rest
+                {
+                    if (cliProcessRxData()) // If cliProcessRxData() returns 1, a received command line can be processed
+                    {
+                        cmdExecuteCommand(&logged_in[instance]);    // Executes all CLI-commands
+
+                        if (!cmdIsPending())    // A pending command prints the prompt once it completed
+                            printPrompt(logged_in[instance]);
+                    }
+                }
+            }
+            cliSelect(0);
         }
 
-        if (cliGetStatusBarFlag() == 1 && seconds != timer2GetSeconds())
+        // the seconds event also ends NEC frames missing edges
+        if (pollAll || event.type == EVENT_CAPTURE || event.type == EVENT_SECOND)
         {
-            seconds = timer2GetSeconds();
-            cliPrintStatusBar(HIDE_CURSOR_ON);
+            if (necProcessRxData() == 1)     // if necProcessRxData() return 1, a received IR-command can be processed
+            {
+                printf("0x%0X%0X%0X%0X%0X", necGetProcessedRxData(0), necGetProcessedRxData(1),
+                    necGetProcessedRxData(2), necGetProcessedRxData(3));
+                printf("\n");
+                necStartReceiving();
+            }
         }
-	}
-}
-
-// TIMER2 ISR
-ISR(TIMER2_COMPA_vect)
-{
-    static unsigned char timeSlot = 0; 
-    static unsigned int milliSecondCounter = 0;
-
-    timer2Tic(timeSlot);
-
-    if (UCSR0A & (1 << RXC0))   // UART-polling
-        cliReceiveByte(UDR0);
-    
-    switch(timeSlot & 0x07)
-    {
-        case 0: // timeSlot 0                   
-
-                // Counting seconds
-                if (milliSecondCounter == 1000)
-                {
-                    PORTB &= ~(1 << PB5);
-                    timer2IncrementSeconds();
-                    milliSecondCounter = 0;
-                }
-                if (milliSecondCounter == 250)
-                    PORTB |= (1 << PB5);
-                milliSecondCounter++;
-                break;
 
-        case 1: //timeSlot 1
-                break;
+        if (pollAll || event.type == EVENT_SCHED)
+            schedService();         // Run the soft tasks due
 
-        case 2: //timeSlot 2
-                break;
-
-        case 3: //timeSlot 3     
-                break;
-
-        case 4: //timeSlot 4     
-                break;
-
-        case 5: //timeSlot 5     
-                break;
+        if ((pollAll || event.type == EVENT_SECOND) && cliGetStatusBarFlag() == 1)
+            cliPrintStatusBar(HIDE_CURSOR_ON);
 
-        case 6: //timeSlot 6      
-                break;
+        for (uint8_t instance = 0; instance < CLI_INSTANCES; instance++)
+        {
+            cliSelect(instance);
+            if (cmdService(&logged_in[instance]))   // Continue a pending command, e.g. waiting for input captures or EVENT_EEPROM
+                printPrompt(logged_in[instance]);
+            if (protoService(&logged_in[instance])) // Serve binary protocol requests, the prompt follows once left
+                printPrompt(logged_in[instance]);
+        }
+        cliSelect(0);
 
-        case 7: //timeSlot 7       
-                break;                          
-    }
-    timer2Toc(timeSlot++);
-    // reset the Output Compare Flag 2 A if
-    // set during the execution of this ISR
-    TIFR2 |= (1 << OCF2A);  
-}
\ No newline at end of file
+        cfgService();               // Hand over changed configuration items to the EEPROM write queue
+	}
+}
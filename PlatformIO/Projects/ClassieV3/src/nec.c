@@ -12,6 +12,7 @@
 #include <avr/io.h>
 #include <avr/interrupt.h>
 
+#include "clock.h"
 #include "nec.h"
 #include "timer1.h"
 
@@ -25,6 +26,7 @@
 #define TOLERANCE               1000
 #define LOGIC_ONE_SPACE         1687
 #define REPEAT_LOW_PULSE        2250
+#define DATA_TIMEOUT            80      // milliseconds to receive all data bits after the leading space
 
 enum NecStates
 {
@@ -46,7 +48,7 @@ struct Nec
     uint8_t dataArray[NEC_DATA_ARRAY_SIZE];
     uint32_t captureArrayIndex;
     volatile uint32_t captureArray[NEC_CAPTURE_ARRAY_SIZE];
-    uint32_t timeStamp;
+    uint32_t deadline;
 };
 
 /****************************************************/
@@ -60,7 +62,7 @@ static struct Nec this =
     .dataArray = {0},
     .captureArrayIndex = 0,
     .captureArray = {0},
-    .timeStamp = 0
+    .deadline = 0
 };
 
 /****************************************************/
@@ -87,6 +89,14 @@ void necStartReceiving()
     timer1StartInputCapture(this.captureArray, NEC_CAPTURE_ARRAY_SIZE);
 }
 
+// Stop receiving pulses, e.g. to capture other signals at ICP1 (PB0) until necStartReceiving() is called
+// Return value: capture array of NEC_CAPTURE_ARRAY_SIZE entries, unused while receiving is stopped
+volatile uint32_t *necStopReceiving()
+{
+    this.state = NEC_IDLE;
+    return this.captureArray;
+}
+
 // Process received NEC pulses until the number of bytes
 // defined in NEC_DATA_ARRAY_SIZE has been reveived
 int8_t necProcessRxData()
@@ -116,7 +126,7 @@ int8_t necProcessRxData()
                 {
                     this.state = NEC_DECODING_DATA;
                     this.captureArrayIndex = 3;
-                    this.timeStamp = timer1GetOverflowCounter();
+                    this.deadline = clockDeadlineMillis(DATA_TIMEOUT);
                 }
                 else
                     necStartReceiving();
@@ -125,7 +135,8 @@ int8_t necProcessRxData()
 
         case NEC_DECODING_DATA:
 
-            if (this.captureArray[this.captureArrayIndex] != 0)
+            // decode all bits captured since the last call
+            while (this.state == NEC_DECODING_DATA && this.captureArray[this.captureArrayIndex] != 0)
             {
                 this.dataArray[this.dataArrayIndex] >>= 1;
 
@@ -133,15 +144,18 @@ int8_t necProcessRxData()
                     this.dataArray[this.dataArrayIndex] |= 0x80;
 
                 this.captureArrayIndex += 2;
-            }
 
-            if (this.captureArrayIndex == (3 + (this.dataArrayIndex + 1) * 16) && this.dataArrayIndex < NEC_DATA_ARRAY_SIZE)
-                this.dataArrayIndex++;
+                if (this.captureArrayIndex == (3 + (this.dataArrayIndex + 1) * 16) && this.dataArrayIndex < NEC_DATA_ARRAY_SIZE)
+                    this.dataArrayIndex++;
+
+                if (this.dataArrayIndex == NEC_DATA_ARRAY_SIZE)
+                    this.state = NEC_END_OF_TRANSMISSION;
+            }
 
-            if (this.dataArrayIndex == NEC_DATA_ARRAY_SIZE)
-                this.state = NEC_END_OF_TRANSMISSION;
+            if (this.state == NEC_END_OF_TRANSMISSION)
+                return 1;
 
-            if (timer1GetOverflowCounter() > this.timeStamp + NEC_DATA_ARRAY_SIZE)
+            if (clockExpiredMillis(this.deadline))
                 necStartReceiving();
         break;
 
@@ -0,0 +1,174 @@
+/*
+ * File:            out.c
+ * Author:          Thomas Jerman
+ * Date Created:    18.10.2026
+ *
+ * Description:
+ * Providing lean formatted output without vfprintf
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include <avr/io.h>
+#include <avr/pgmspace.h>
+
+#include "cli.h"
+#include "out.h"
+
+/****************************************************/
+// LOCAL DEFINES
+/****************************************************/
+
+#define OUT_CHUNK_SIZE      16      // characters of a program memory string copied per cliWrite()
+
+/****************************************************/
+// LOCAL STRUCT DEFINITION
+/****************************************************/
+
+/****************************************************/
+// LOCAL STATIC STRUCT VARIABLE DECLARATION, INIT
+/****************************************************/
+
+/****************************************************/
+// LOCAL MACROS
+/****************************************************/
+
+/****************************************************/
+// LOCAL FUNCTIONS
+/****************************************************/
+
+// Convert value to decimal digits ending in front of end, switching to 16 bit divisions once value fits
+// Return value: number of digits
+static uint8_t formatDigits(char *end, uint32_t value)
+{
+    char *digit = end;
+    uint16_t small;
+
+    while (value > 0xFFFF)
+    {
+        *--digit = '0' + value % 10;
+        value /= 10;
+    }
+    small = value;
+    do
+    {
+        *--digit = '0' + small % 10;
+        small /= 10;
+    } while (small);
+    return end - digit;
+}
+
+// Copy length characters of text right-aligned to width characters filled with pad into buffer, '\0' terminated
+// Return value: number of characters copied
+static uint8_t padText(char *buffer, const char *text, uint8_t length, uint8_t width, char pad)
+{
+    uint8_t fill = width > length ? width - length : 0;
+
+    memset(buffer, pad, fill);
+    memcpy(buffer + fill, text, length);
+    buffer[fill + length] = '\0';
+    return fill + length;
+}
+
+/****************************************************/
+// GLOBAL FUNCTIONS
+/****************************************************/
+
+// Format value right-aligned to width characters filled with pad (' ' or '0') into buffer, '\0' terminated
+// buffer has to hold width + 1 or OUT_NUMBER_SIZE bytes, whichever is larger
+// Return value: number of characters formatted
+uint8_t outFormatUnsigned(char *buffer, uint32_t value, uint8_t width, char pad)
+{
+    char digits[OUT_NUMBER_SIZE];
+    char *end = digits + sizeof(digits);
+    uint8_t length = formatDigits(end, value);
+
+    return padText(buffer, end - length, length, width, pad);
+}
+
+// Format value scaled by 10^decimals as fixed-point number right-aligned to width characters into buffer,
+// e.g. value 1234 with 1 decimal as "123.4", buffer size as of outFormatUnsigned(), fraction digits beyond
+// OUT_DECIMALS_MAX are cut off
+// Return value: number of characters formatted
+uint8_t outFormatFixed(char *buffer, uint32_t value, uint8_t decimals, uint8_t width)
+{
+    char digits[OUT_NUMBER_SIZE];
+    char *end = digits + sizeof(digits);
+    char *first = end;
+
+    // the digits buffer holds no more fraction digits, cut off the least significant ones
+    for (; decimals > OUT_DECIMALS_MAX; decimals--)
+        value /= 10;
+    // the fraction digits, followed by the integer digits in front of the decimal point
+    for (uint8_t i = 0; i < decimals; i++)
+    {
+        *--first = '0' + value % 10;
+        value /= 10;
+    }
+    if (decimals)
+        *--first = '.';
+    first -= formatDigits(first, value);
+    return padText(buffer, first, end - first, width, ' ');
+}
+
+// Format value as digits upper case hexadecimal digits with leading zeros into buffer, '\0' terminated
+// Return value: number of characters formatted
+uint8_t outFormatHex(char *buffer, uint16_t value, uint8_t digits)
+{
+    uint8_t nibble;
+
+    buffer[digits] = '\0';
+    for (uint8_t i = digits; i > 0; i--)
+    {
+        nibble = value & 0x0F;
+        buffer[i - 1] = nibble < 10 ? '0' + nibble : 'A' - 10 + nibble;
+        value >>= 4;
+    }
+    return digits;
+}
+
+// Write value right-aligned to width characters filled with spaces, like printf("%*lu")
+void outUnsigned(uint32_t value, uint8_t width)
+{
+    char buffer[OUT_WIDTH_MAX + 1];
+
+    if (width > OUT_WIDTH_MAX)
+        width = OUT_WIDTH_MAX;
+    cliWrite(buffer, outFormatUnsigned(buffer, value, width, ' '));
+}
+
+// Write value scaled by 10^decimals as fixed-point number right-aligned to width characters, like printf("%*.*f")
+// with at most OUT_DECIMALS_MAX fraction digits
+void outFixed(uint32_t value, uint8_t decimals, uint8_t width)
+{
+    char buffer[OUT_WIDTH_MAX + 1];
+
+    if (width > OUT_WIDTH_MAX)
+        width = OUT_WIDTH_MAX;
+    cliWrite(buffer, outFormatFixed(buffer, value, decimals, width));
+}
+
+// Write value as digits upper case hexadecimal digits with leading zeros, like printf("%0*X")
+void outHex(uint16_t value, uint8_t digits)
+{
+    char buffer[5];
+
+    if (digits > 4)
+        digits = 4;
+    cliWrite(buffer, outFormatHex(buffer, value, digits));
+}
+
+// Write the '\0' terminated string stored in program memory, e.g. outString_P(PSTR("text"))
+void outString_P(const char *string)
+{
+    char chunk[OUT_CHUNK_SIZE];
+    uint8_t length;
+
+    do
+    {
+        for (length = 0; length < OUT_CHUNK_SIZE && (chunk[length] = pgm_read_byte(string + length)) != '\0'; length++);
+        cliWrite(chunk, length);
+        string += length;
+    } while (length == OUT_CHUNK_SIZE);
+}
@@ -0,0 +1,320 @@
+/*
+ * File:            proto.c
+ * Author:          Thomas Jerman
+ * Date Created:    18.10.2026
+ *
+ * Description:
+ * Providing a COBS framed binary request/response protocol executing the CLI commands
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include <avr/io.h>
+#include <util/crc16.h>
+
+#include "cli.h"
+#include "cmd.h"
+#include "proto.h"
+
+/****************************************************/
+// LOCAL DEFINES
+/****************************************************/
+
+// Positions of the frame header
+#define PROTO_SEQ                   0
+#define PROTO_ID                    1
+#define PROTO_TYPE                  2
+#define PROTO_STATUS                3
+
+#define PROTO_CRC_SIZE              2
+#define PROTO_REQUEST_HEADER        3       // SEQ, ID and TYPE
+#define PROTO_RESPONSE_HEADER       4       // SEQ, ID, TYPE and STATUS
+#define PROTO_REQUEST_SIZE          (PROTO_REQUEST_HEADER + REC_CHAR_MAX + PROTO_CRC_SIZE)
+#define PROTO_RESPONSE_SIZE         (PROTO_RESPONSE_HEADER + PROTO_RESULT_MAX + PROTO_CRC_SIZE)
+#define COBS_BLOCK_MAX              254     // non-zero bytes of a COBS block with code 0xFF
+
+/****************************************************/
+// LOCAL STRUCT DEFINITION
+/****************************************************/
+
+// Declaration of the binary protocol struct, one per CLI instance
+struct Proto
+{
+    uint8_t active;                     // 1 once the switch to binary mode has been acknowledged
+    uint8_t request[PROTO_REQUEST_SIZE];    // decoded request frame
+    uint8_t requestLength;              // bytes decoded, PROTO_REQUEST_SIZE + 1 if the frame is too long
+    uint8_t blockLeft;                  // bytes left of the current COBS block, 0: the next byte is a block code
+    uint8_t zeroPending;                // 1 if a zero follows the current COBS block
+    uint8_t response[PROTO_RESPONSE_SIZE];  // response of the command executing or answered last
+    uint8_t resultLength;               // result bytes in response
+    uint8_t overflow;                   // 1 if results did not fit into response
+    uint8_t collecting;                 // 1 while the command of a request executes
+    uint8_t answered;                   // 1 if response holds the answer of the command request lastSeq, lastId
+    uint8_t lastSeq;                    // SEQ of the command request answered by response
+    uint8_t lastId;                     // ID of the command request answered by response
+    uint8_t seq;                        // SEQ of the next response
+};
+
+/****************************************************/
+// LOCAL STATIC STRUCT VARIABLE DECLARATION, INIT
+/****************************************************/
+
+static struct Proto instances[CLI_INSTANCES];
+
+/****************************************************/
+// LOCAL MACROS
+/****************************************************/
+
+// Requests are served on the CLI instance selected, a single instance is addressed directly
+#if CLI_INSTANCES > 1
+#define this                        instances[cliGetInstance()]
+#else
+#define this                        instances[0]
+#endif
+
+/****************************************************/
+// LOCAL FUNCTIONS
+/****************************************************/
+
+// Get the CRC-16/XMODEM of length bytes
+static uint16_t crc16(const uint8_t *data, uint8_t length)
+{
+    uint16_t crc = 0;
+
+    while (length--)
+        crc = _crc_xmodem_update(crc, *data++);
+    return crc;
+}
+
+// COBS encode length bytes and send them followed by the frame delimiter
+static void sendFrame(const uint8_t *data, uint8_t length)
+{
+    const uint8_t *end = data + length;
+    const uint8_t *block;
+    uint8_t code;
+
+    while (1)
+    {
+        // each block of non-zero bytes is preceded by its length + 1, the zero ending it is implied
+        block = data;
+        while (data < end && *data != 0 && data - block < COBS_BLOCK_MAX)
+            data++;
+        code = data - block + 1;
+        cliWriteBinary(&code, 1);
+        cliWriteBinary(block, code - 1);
+        if (data == end)
+            break;
+        // the zero ending a shorter block is implied, a block of code 0xFF is followed by the next block
+        // instead, a trailing zero is followed by an empty block
+        if (code != 0xFF)
+            data++;
+    }
+    code = 0;
+    cliWriteBinary(&code, 1);
+}
+
+// Append the CRC-16 to length bytes of frame and send it, the SEQ of the response is set before
+static void sendWithCrc(uint8_t *frame, uint8_t length)
+{
+    uint16_t crc;
+
+    frame[PROTO_SEQ] = this.seq++;
+    crc = crc16(frame, length);
+    frame[length] = crc >> 8;
+    frame[length + 1] = crc;
+    sendFrame(frame, length + PROTO_CRC_SIZE);
+}
+
+// Answer the request decoded by status without result, e.g. a busy command request
+static void sendStatus(uint8_t status)
+{
+    uint8_t frame[PROTO_RESPONSE_HEADER + PROTO_CRC_SIZE];
+
+    frame[PROTO_ID] = this.request[PROTO_ID];
+    frame[PROTO_TYPE] = this.request[PROTO_TYPE] | PROTO_RESPONSE;
+    frame[PROTO_STATUS] = status;
+    sendWithCrc(frame, PROTO_RESPONSE_HEADER);
+}
+
+// Start collecting the response of the command request decoded
+static void beginResponse()
+{
+    this.lastSeq = this.request[PROTO_SEQ];
+    this.lastId = this.request[PROTO_ID];
+    this.response[PROTO_ID] = this.lastId;
+    this.response[PROTO_TYPE] = PROTO_COMMAND | PROTO_RESPONSE;
+    this.resultLength = 0;
+    this.overflow = 0;
+    this.answered = 0;
+    this.collecting = 1;
+}
+
+// Send the response of the command request with status and the results collected
+static void sendResponse(uint8_t status)
+{
+    if (status == PROTO_OK && this.overflow)
+        status = PROTO_OVERFLOW;
+    this.response[PROTO_STATUS] = status;
+    this.collecting = 0;
+    this.answered = 1;
+    sendWithCrc(this.response, PROTO_RESPONSE_HEADER + this.resultLength);
+}
+
+// Decode a received byte of a COBS encoded frame into this.request
+// Return value: length of the frame decoded if its length and CRC-16 are valid, 0 if not complete yet or dropped
+static uint8_t decodeByte(uint8_t byte)
+{
+    uint8_t length = this.requestLength;
+
+    // frame delimiter, the zero implied by the last block belongs to the delimiter
+    if (byte == 0)
+    {
+        // a frame ending within a block is truncated
+        if (this.blockLeft)
+            length = 0;
+        this.requestLength = 0;
+        this.blockLeft = 0;
+        this.zeroPending = 0;
+        if (length < PROTO_REQUEST_HEADER + PROTO_CRC_SIZE || length > PROTO_REQUEST_SIZE)
+            return 0;
+        // the CRC over a frame ending with its CRC is 0
+        return crc16(this.request, length) == 0 ? length : 0;
+    }
+    if (this.blockLeft == 0)
+    {
+        // block code, a zero ends the previous block unless it was a block of COBS_BLOCK_MAX bytes
+        this.blockLeft = byte - 1;
+        if (!this.zeroPending)
+        {
+            this.zeroPending = byte != 0xFF;
+            return 0;
+        }
+        this.zeroPending = byte != 0xFF;
+        byte = 0;
+    }
+    else
+        this.blockLeft--;
+    if (length < PROTO_REQUEST_SIZE)
+        this.request[length] = byte;
+    if (length <= PROTO_REQUEST_SIZE)
+        this.requestLength = length + 1;
+    return 0;
+}
+
+// Execute the command line of the request decoded with length bytes, its response is sent once the command
+// completed
+static void executeCommand(uint8_t length, uint8_t *login_status)
+{
+    CmdHandler handler;
+    uint8_t status;
+
+    if (cmdIsPending())
+    {
+        sendStatus(PROTO_BUSY);
+        return;
+    }
+    // a repeated request is answered again without executing the command twice
+    if (this.answered && this.request[PROTO_SEQ] == this.lastSeq && this.request[PROTO_ID] == this.lastId)
+    {
+        sendFrame(this.response, PROTO_RESPONSE_HEADER + this.resultLength + PROTO_CRC_SIZE);
+        return;
+    }
+
+    beginResponse();
+    cliSetCommandLine((const char *) this.request + PROTO_REQUEST_HEADER,
+        length - PROTO_REQUEST_HEADER - PROTO_CRC_SIZE);
+    // an empty command line is answered right away, e.g. to measure the round trip time
+    if (cliGetArgc() == 0)
+    {
+        sendResponse(PROTO_OK);
+        return;
+    }
+    status = cmdBindCommand(*login_status, &handler);
+    if (status != CMD_BOUND)
+    {
+        sendResponse(status == CMD_UNKNOWN ? PROTO_UNKNOWN : PROTO_INVALID);
+        return;
+    }
+    handler(login_status);
+    // a resumable command runs up to its first wait, protoService() answers once it completed
+    if (!cmdIsPending() || cmdService(login_status))
+        sendResponse(PROTO_OK);
+}
+
+// Cancel the command pending, the command request started it is answered first
+static void cancelCommand(uint8_t *login_status)
+{
+    if (cmdCancel(login_status) && this.collecting)
+        sendResponse(PROTO_CANCELLED);
+}
+
+/****************************************************/
+// GLOBAL FUNCTIONS
+/****************************************************/
+
+// Decode the requests received in binary mode of the CLI instance selected and send the responses,
+// call cyclically from the main loop
+// Return value:    1: switched back to the command line, print the prompt
+//                  0: binary mode continues or is not entered
+uint8_t protoService(uint8_t *login_status)
+{
+    uint8_t byte, length;
+
+    if (!cliIsBinaryMode())
+        return 0;
+
+    // acknowledge the switch by a frame delimiter, text sent before ends there for the client
+    if (!this.active)
+    {
+        memset(&this, 0, sizeof(this));
+        this.active = 1;
+        byte = 0;
+        cliWriteBinary(&byte, 1);
+    }
+
+    // the command of the last request completed meanwhile, e.g. waiting for the EEPROM write queue
+    if (this.collecting && !cmdIsPending())
+        sendResponse(PROTO_OK);
+
+    while (cliReadByte(&byte))
+    {
+        if ((length = decodeByte(byte)) == 0)
+            continue;
+        switch (this.request[PROTO_TYPE])
+        {
+            case PROTO_COMMAND:
+                executeCommand(length, login_status);
+                break;
+            case PROTO_CANCEL:
+                cancelCommand(login_status);
+                sendStatus(PROTO_OK);
+                break;
+            case PROTO_EXIT:
+                cancelCommand(login_status);
+                sendStatus(PROTO_OK);
+                this.active = 0;
+                cliSetBinaryMode(0);
+                return 1;
+            default:
+                sendStatus(PROTO_BAD_TYPE);
+                break;
+        }
+    }
+    return 0;
+}
+
+// Append length bytes to the result of the command executed by a request, called by command handlers,
+// nothing is done for commands typed at the command line
+void protoPutResult(const void *data, uint8_t length)
+{
+    if (!this.collecting)
+        return;
+    if (length > PROTO_RESULT_MAX - this.resultLength)
+    {
+        length = PROTO_RESULT_MAX - this.resultLength;
+        this.overflow = 1;
+    }
+    memcpy(this.response + PROTO_RESPONSE_HEADER + this.resultLength, data, length);
+    this.resultLength += length;
+}
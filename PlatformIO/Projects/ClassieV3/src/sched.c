@@ -0,0 +1,234 @@
+/*
+ * File:            sched.c
+ * Author:          Thomas Jerman
+ * Date Created:    18.10.2026
+ *
+ * Description:
+ * Providing a cooperative task scheduler on top of the 125 us frames of Timer2
+ */
+
+#include <stdio.h>
+
+#include <avr/io.h>
+#include <avr/interrupt.h>
+#include <util/atomic.h>
+
+#include "clock.h"
+#include "event.h"
+#include "sched.h"
+#include "timer2.h"
+
+/****************************************************/
+// LOCAL DEFINES
+/****************************************************/
+
+/****************************************************/
+// LOCAL STRUCT DEFINITION
+/****************************************************/
+
+// Registered task
+struct SchedTask
+{
+    void (*function)();                 // task function
+    uint16_t period;                    // frames between two runs, 0 while suspended
+    uint16_t countdown;                 // frames until the next run
+    uint8_t flags;                      // SCHED_SOFT, SCHED_DEMOTED
+    volatile uint8_t pending;           // set by the ISR, cleared by schedService() before running the task
+    volatile uint8_t running;           // 1 while schedService() runs the task
+    uint8_t overrunsInRow;              // consecutive overruns of a hard task
+    volatile uint16_t overruns;         // overruns since startup
+};
+
+// Declaration of the scheduler struct
+struct Sched
+{
+    struct SchedTask tasks[SCHED_TASKS_MAX];
+    volatile uint8_t count;             // number of registered tasks
+    uint8_t frame;                      // frame counter, selects the tic toc slot
+    volatile uint16_t frameOverruns;    // frames overrunning the next compare match
+};
+
+/****************************************************/
+// LOCAL STATIC STRUCT VARIABLE DECLARATION, INIT
+/****************************************************/
+
+static struct Sched this;
+
+/****************************************************/
+// LOCAL MACROS
+/****************************************************/
+
+// Frame budget used up: next compare match passed or TCNT2 beyond SCHED_FRAME_BUDGET
+#define FRAME_BUDGET_EXCEEDED()     ((TIFR2 & (1 << OCF2A)) || TCNT2 >= SCHED_FRAME_BUDGET)
+
+/****************************************************/
+// LOCAL FUNCTIONS
+/****************************************************/
+
+// Count an overrun of a hard task and demote it after SCHED_OVERRUN_LIMIT overruns in a row
+static void countOverrun(struct SchedTask *task)
+{
+    task->overruns++;
+    if (++task->overrunsInRow >= SCHED_OVERRUN_LIMIT)
+        task->flags |= SCHED_SOFT | SCHED_DEMOTED;
+}
+
+// Run or flag all tasks due in this frame, called by ISR(TIMER2_COMPA_vect)
+static void runFrame()
+{
+    for (uint8_t index = 0; index < this.count; index++)
+    {
+        struct SchedTask *task = &this.tasks[index];
+
+        if (task->period == 0 || --task->countdown)
+            continue;
+        task->countdown = task->period;
+
+        if (task->flags & SCHED_SOFT)
+        {
+            // still waiting for the main loop
+            if (task->pending)
+                task->overruns++;
+            else
+                eventPost(EVENT_SCHED, index);
+            task->pending = 1;
+        }
+        else if (task->pending || task->running)
+        {
+            // the run handed over to the main loop has not completed yet, a hard task never runs twice at a time
+            task->overruns++;
+        }
+        else if (FRAME_BUDGET_EXCEEDED())
+        {
+            // no time left in this frame, hand over this run to the main loop
+            eventPost(EVENT_SCHED, index);
+            task->pending = 1;
+        }
+        else
+        {
+            task->function();
+            if (FRAME_BUDGET_EXCEEDED())
+                countOverrun(task);
+            else
+                task->overrunsInRow = 0;
+        }
+    }
+}
+
+/****************************************************/
+// GLOBAL FUNCTIONS
+/****************************************************/
+
+// Register function to be run every period frames, the first time in frame phase (0 = next frame)
+// flags: SCHED_HARD or SCHED_SOFT
+// Return value: task number, SCHED_INVALID_TASK if all tasks are used or period is 0
+uint8_t schedAddTask(void (*function)(), uint16_t period, uint16_t phase, uint8_t flags)
+{
+    uint8_t index = SCHED_INVALID_TASK;
+
+    if (function == NULL || period == 0)
+        return SCHED_INVALID_TASK;
+
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+    {
+        if (this.count < SCHED_TASKS_MAX)
+        {
+            struct SchedTask *task = &this.tasks[this.count];
+            task->function = function;
+            task->period = period;
+            task->countdown = phase + 1;
+            task->flags = flags & SCHED_SOFT;
+            task->pending = 0;
+            task->running = 0;
+            task->overrunsInRow = 0;
+            task->overruns = 0;
+            index = this.count++;
+        }
+    }
+    return index;
+}
+
+// Run all soft tasks flagged by ISR(TIMER2_COMPA_vect), call in the main loop
+void schedService()
+{
+    for (uint8_t index = 0; index < this.count; index++)
+    {
+        struct SchedTask *task = &this.tasks[index];
+        if (task->pending)
+        {
+            task->running = 1;
+            task->pending = 0;
+            task->function();
+            task->running = 0;
+        }
+    }
+}
+
+// Change the period of task, the next run is in frame phase (0 = next frame), period 0 suspends task
+// Return value:    1: period changed
+//                  0: invalid task
+uint8_t schedSetPeriod(uint8_t task, uint16_t period, uint16_t phase)
+{
+    if (task >= this.count)
+        return 0;
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+    {
+        this.tasks[task].period = period;
+        this.tasks[task].countdown = phase + 1;
+        this.tasks[task].pending = 0;
+    }
+    return 1;
+}
+
+// Get the number of registered tasks
+uint8_t schedGetTaskCount()
+{
+    return this.count;
+}
+
+// Get the flags of task, 0 for an invalid task
+uint8_t schedGetFlags(uint8_t task)
+{
+    if (task < this.count)
+        return this.tasks[task].flags;
+    return 0;
+}
+
+// Get the overruns of task: a hard task exceeding the frame budget or due again before schedService() completed
+// the run handed over, a soft task flagged again before schedService() ran it, 0 for an invalid task
+uint16_t schedGetOverruns(uint8_t task)
+{
+    uint16_t overruns = 0;
+    if (task < this.count)
+        ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+            overruns = this.tasks[task].overruns;
+    return overruns;
+}
+
+// Get the number of frames whose ISR was still running at the next compare match
+uint16_t schedGetFrameOverruns()
+{
+    uint16_t overruns;
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+        overruns = this.frameOverruns;
+    return overruns;
+}
+
+// Timer2 frame of 125 us: runs the hard tasks and flags the soft tasks due
+ISR(TIMER2_COMPA_vect)
+{
+    uint8_t slot = this.frame++ & (MAX_TIC_TOCS_AVAILABLE - 1);
+
+    clockTick();
+    timer2Tic(slot);
+    runFrame();
+    timer2Toc(slot);
+
+    // reset the Output Compare Flag 2 A if
+    // set during the execution of this ISR
+    if (TIFR2 & (1 << OCF2A))
+    {
+        this.frameOverruns++;
+        TIFR2 |= (1 << OCF2A);
+    }
+}
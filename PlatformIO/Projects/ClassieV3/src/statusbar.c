@@ -4,7 +4,7 @@
  * Date Created:    07.04.2024
  *
  * Description:
- * Providing a function to set up a status bar
+ * Providing the status bar fields of the application
  */
 
 #include <stdio.h>
@@ -17,12 +17,17 @@
 
 #include "cli.h"
 #include "cmd.h"
+#include "eeq.h"
+#include "idle.h"
+#include "out.h"
 #include "timer2.h"
 
 /****************************************************/
 // LOCAL DEFINES
 /****************************************************/
 
+#define STATUS_FIELDS_COUNT     (sizeof(statusFields) / sizeof(statusFields[0]))
+
 /****************************************************/
 // LOCAL STRUCT DEFINITION
 /****************************************************/
@@ -39,22 +44,67 @@
 // LOCAL FUNCTIONS
 /****************************************************/
 
+// The formatters below write up to OUT_NUMBER_SIZE + 6 bytes into buffers of CLI_STATUS_VALUE_SIZE bytes
+
+// Session time as HH:MM:SS
+static void formatSessionTime(char *buffer, uint8_t size, uint8_t arg)
+{
+    unsigned long seconds = timer2GetSeconds();
+    unsigned long minutes = seconds / 60;
+    uint8_t length;
+
+    length = outFormatUnsigned(buffer, minutes / 60, 2, '0');
+    buffer[length++] = ':';
+    length += outFormatUnsigned(buffer + length, minutes % 60, 2, '0');
+    buffer[length++] = ':';
+    outFormatUnsigned(buffer + length, seconds % 60, 2, '0');
+}
+
+// Bytes waiting in the EEPROM write queue
+static void formatEepromPending(char *buffer, uint8_t size, uint8_t arg)
+{
+    outFormatUnsigned(buffer, eeqGetPending(), 4, ' ');
+}
+
+// CPU load of the last measurement window
+static void formatCpuLoad(char *buffer, uint8_t size, uint8_t arg)
+{
+    strcpy_P(buffer + outFormatUnsigned(buffer, idleGetLoad(), 3, ' '), PSTR(" %"));
+}
+
+// Share of the 125 us frame used by Timer2 slot arg, rounded to percent
+static void formatTaskLoad(char *buffer, uint8_t size, uint8_t arg)
+{
+    strcpy_P(buffer + outFormatUnsigned(buffer, (timer2GetTicTocTime(arg) + 625) / 1250, 2, ' '), PSTR(" %"));
+}
+
+// Status bar fields: label, row, column, width, format function, argument
+// Setup any number of status bar fields to be stored in program memory
+// ***********************************************************************************
+static const struct CliStatusField statusFields[] PROGMEM =
+{
+    {"Session time: ",                  0,  0,  8,  formatSessionTime,      0},
+    {" | EEPROM: ",                     0,  22, 4,  formatEepromPending,    0},
+    {" bytes pending | CPU load: ",     0,  37, 5,  formatCpuLoad,          0},
+    {"TASK0: ",                         1,  0,  4,  formatTaskLoad,         0},
+    {" | TASK1: ",                      1,  11, 4,  formatTaskLoad,         1},
+    {" | TASK2: ",                      1,  25, 4,  formatTaskLoad,         2},
+    {" | TASK3: ",                      1,  39, 4,  formatTaskLoad,         3},
+    {" of 125 us task time used",       1,  53, 0,  NULL,                   0},
+    {"TASK4: ",                         2,  0,  4,  formatTaskLoad,         4},
+    {" | TASK5: ",                      2,  11, 4,  formatTaskLoad,         5},
+    {" | TASK6: ",                      2,  25, 4,  formatTaskLoad,         6},
+    {" | TASK7: ",                      2,  39, 4,  formatTaskLoad,         7},
+    {" of 125 us task time used",       2,  53, 0,  NULL,                   0},
+};
+// ***********************************************************************************
+
 /****************************************************/
 // GLOBAL FUNCTIONS
 /****************************************************/
 
-// Status bar setup
-void statusBar()
+// Register the status bar fields, only changed values are redrawn
+void statusBarRegister()
 {
-    printf_P(PSTR(TXT_COLOR_REVERSE));
-    // Setup any number of status bar lines to be stored and printed from program memory
-    // ***********************************************************************************
-    printf_P(PSTR("Session time: %02d:%02d:%02d                                                         \n"),
-        (int)(timer2GetSeconds() / 3600), (int)((timer2GetSeconds() / 60) % 60), (int)(timer2GetSeconds() % 60));
-    printf_P(PSTR("TASK0: %2lu %% | TASK1: %2lu %% | TASK2: %2lu %% | TASK3: %2lu %% of 125 us task time used \n"),
-        (timer2GetTicTocTime(0) / 1250) + 1, (timer2GetTicTocTime(1) / 1250) + 1, (timer2GetTicTocTime(2) / 1250) + 1,(timer2GetTicTocTime(3) / 1250) + 1);
-    printf_P(PSTR("TASK4: %2lu %% | TASK5: %2lu %% | TASK6: %2lu %% | TASK7: %2lu %% of 125 us task time used \n"),
-        (timer2GetTicTocTime(4) / 1250) + 1, (timer2GetTicTocTime(5) / 1250) + 1, (timer2GetTicTocTime(6) / 1250) + 1,(timer2GetTicTocTime(7) / 1250) + 1);
-    // ***********************************************************************************
-    printf_P(PSTR(TXT_RESET_FORMAT));
-}
\ No newline at end of file
+    cliSetStatusFields(statusFields, STATUS_FIELDS_COUNT);
+}
@@ -12,6 +12,7 @@
 #include <avr/io.h>
 #include <avr/interrupt.h>
 
+#include "event.h"
 #include "template.h"
 
 /****************************************************/
@@ -96,7 +97,10 @@ ISR(TIMER1_CAPT_vect)
     TIFR1 |= (1 << ICF1);       // Clear ICF1 (by writing a logical one to it) after toggling of the edge trigger
 
     if (this.captureArrayIndex < this.captureArraySize && this.previousCapture)
-        this.captureArray[this.captureArrayIndex++] = (this.currentCapture - this.previousCapture)/2;
+    {
+        this.captureArray[this.captureArrayIndex] = (this.currentCapture - this.previousCapture)/2;
+        eventPost(EVENT_CAPTURE, (uint8_t) this.captureArrayIndex++);
+    }
 
     this.previousCapture = this.currentCapture;
 }
\ No newline at end of file
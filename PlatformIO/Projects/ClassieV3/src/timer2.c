@@ -11,6 +11,8 @@
 #include <string.h>
 
 #include <avr/io.h>
+#include <avr/pgmspace.h>
+#include <util/atomic.h>
 
 #include "timer2.h"
 
@@ -25,9 +27,9 @@
 struct Timer2
 {
     unsigned int period;
-    unsigned long seconds;
-    unsigned int tic[MAX_TIC_TOCS_AVAILABLE];
-    unsigned int toc[MAX_TIC_TOCS_AVAILABLE];
+    volatile unsigned long seconds;
+    uint8_t tic[MAX_TIC_TOCS_AVAILABLE];
+    struct Timer2SlotStats slots[MAX_TIC_TOCS_AVAILABLE];  // accumulated by timer2Toc()
 };
 
 /****************************************************/
@@ -36,14 +38,31 @@ struct Timer2
 
 static struct Timer2 this;
 
+// log2 of 0 to 15, 0 for 0 and 1
+static const uint8_t log2Table[16] PROGMEM = {0, 0, 1, 1, 2, 2, 2, 2, 3, 3, 3, 3, 3, 3, 3, 3};
+
 /****************************************************/
 // LOCAL MACROS
 /****************************************************/
 
+// Increment a 16 bit counter, stopping at its maximum
+#define INCREMENT_SATURATED(counter)    if ((counter) != 0xFFFF) (counter)++
+
 /****************************************************/
 // LOCAL FUNCTIONS
 /****************************************************/
 
+// Get the histogram bin of duration: [2^bin, 2^(bin + 1)) counts, bin 0 also holds 0
+// and the last bin all durations beyond
+static uint8_t getHistogramBin(uint16_t duration)
+{
+    if (duration >= (1 << (TIMER2_HISTOGRAM_BINS - 1)))
+        return TIMER2_HISTOGRAM_BINS - 1;
+    if (duration >= 16)
+        return 4 + pgm_read_byte(&log2Table[duration >> 4]);
+    return pgm_read_byte(&log2Table[duration]);
+}
+
 /****************************************************/
 // GLOBAL FUNCTIONS
 /****************************************************/
@@ -55,17 +74,15 @@ int timer2CTCInit()
 	TIMSK2 |= (1 << OCIE2A);
     // set CTC-MODE: WGM02:0 = 2
 	TCCR2A |= (1 << WGM21);
-    // set OCR0A to 200. 200 * 0.5 us = 100 us
-    //OCR2A = 199;  //for 115200 Baud
-    OCR2A = 249;    //for 76800  Baud
+    // set OCR2A to 249. 250 * 0.5 us = 125 us
+    // UART receiving is handled by ISR(USART_RX_vect) and does not depend on this period
+    OCR2A = 249;
     // set Clock Select Bits to clk/8 for 0.5 us counter clock
     TCCR2B |= (1 << CS21);
-    // initialize .tic and .toc array
+    // initialize .tic array and the statistics
     for (uint8_t index = 0; index < MAX_TIC_TOCS_AVAILABLE; index++)
-    {
         this.tic[index] = 0;
-        this.toc[index] = 0;
-    }
+    timer2ResetSlotStats();
     // set timer2 period in nano seconds
     this.period = 500;
     // initialize timerSeconds
@@ -80,26 +97,75 @@ void timer2Tic(uint8_t number)
         this.tic[number] = TCNT2;
 }
 
-// Save TCNT2 as stop time
+// Save TCNT2 as stop time and add the duration since timer2Tic() to the statistics of number
+// Called within ISR(TIMER2_COMPA_vect): a compare match in between is counted as deadline miss
 void timer2Toc(uint8_t number)
 {
-    if(number >= 0 && number < MAX_TIC_TOCS_AVAILABLE)
-        this.toc[number] = TCNT2;
+    uint8_t toc = TCNT2;
+    uint16_t duration;
+    struct Timer2SlotStats *slot;
+
+    if (number >= MAX_TIC_TOCS_AVAILABLE)
+        return;
+    slot = &this.slots[number];
+    duration = (uint8_t) (toc - this.tic[number]);
+    // TCNT2 was cleared at the next compare match, the frame is exceeded
+    if (TIFR2 & (1 << OCF2A))
+    {
+        duration = OCR2A + 1 - this.tic[number] + toc;
+        INCREMENT_SATURATED(slot->misses);
+    }
+    slot->last = duration;
+    if (duration < slot->min)
+        slot->min = duration;
+    if (duration > slot->max)
+        slot->max = duration;
+    slot->sum += duration;
+    slot->count++;
+    INCREMENT_SATURATED(slot->histogram[getHistogramBin(duration)]);
 }
 
 // Get tic toc durations for available tasks
 // In case of an invalid task: return value = 0
 unsigned long timer2GetTicTocTime(uint8_t task)
 {
-    if (task >= 0 && task < MAX_TIC_TOCS_AVAILABLE)
-        return (this.toc[task] - this.tic[task]) * ((unsigned long) this.period);
-    return 0;
+    uint16_t last = 0;
+    if (task < MAX_TIC_TOCS_AVAILABLE)
+        ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+            last = this.slots[task].last;
+    return last * ((unsigned long) this.period);
 }
 
-// Return timer2 seconds
+// Copy the statistics of slot to stats, durations are given in counts of 0.5 us
+// Return value:    1: stats copied
+//                  0: invalid slot
+uint8_t timer2GetSlotStats(uint8_t slot, struct Timer2SlotStats *stats)
+{
+    if (slot >= MAX_TIC_TOCS_AVAILABLE)
+        return 0;
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+        *stats = this.slots[slot];
+    return 1;
+}
+
+// Reset the statistics of all slots
+void timer2ResetSlotStats()
+{
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+    {
+        memset(this.slots, 0, sizeof(this.slots));
+        for (uint8_t index = 0; index < MAX_TIC_TOCS_AVAILABLE; index++)
+            this.slots[index].min = 0xFFFF;
+    }
+}
+
+// Return timer2 seconds, read atomically as they are incremented within an ISR
 unsigned long timer2GetSeconds()
 {
-    return this.seconds;
+    unsigned long seconds;
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+        seconds = this.seconds;
+    return seconds;
 }
 
 // Increase timer2 seconds
@@ -0,0 +1,326 @@
+/*
+ * File:            isrbench.c
+ * Author:          Thomas Jerman
+ * Date Created:    18.10.2026
+ *
+ * Description:
+ * ISR cycle budget check: runs the firmware ELF in simavr, injects UART bytes and
+ * NEC edge trains on ICP1 and reports worst-case and mean cycles of each ISR and the
+ * maximum interrupt latency (cycles from raising an interrupt to entering its vector).
+ * Fails if an ISR or the latency exceeds the budget file
+ *
+ * Usage: isrbench FIRMWARE.elf BUDGET_FILE [SIMULATED_MS]
+ * Build: cc -O2 -o isrbench isrbench.c -lsimavr -lelf
+ * Return value: 0 all budgets met, 1 budget exceeded, 2 setup error
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <simavr/avr_ioport.h>
+#include <simavr/avr_timer.h>
+#include <simavr/avr_uart.h>
+#include <simavr/sim_avr.h>
+#include <simavr/sim_elf.h>
+#include <simavr/sim_interrupts.h>
+#include <simavr/sim_irq.h>
+
+/****************************************************/
+// LOCAL DEFINES
+/****************************************************/
+
+#define MCU                 "atmega328p"
+#define F_CPU               16000000UL
+#define BAUD_RATE           76800UL
+#define DEFAULT_MS          2000            // simulated time
+#define VECTORS_MAX         26              // vectors of the ATmega328P including RESET
+#define BUDGET_LATENCY      "latency"       // budget file key of the maximum interrupt latency
+
+#define CYCLES_PER_US       (F_CPU / 1000000UL)
+#define CYCLES_PER_BYTE     (F_CPU * 10 / BAUD_RATE)    // start bit, 8 data bits, stop bit
+
+// NEC frame timing in microseconds
+#define NEC_LEADING_PULSE   9000
+#define NEC_LEADING_SPACE   4500
+#define NEC_BIT_PULSE       562
+#define NEC_ZERO_SPACE      562
+#define NEC_ONE_SPACE       1687
+#define NEC_FRAME_PERIOD    110000
+
+/****************************************************/
+// LOCAL STRUCT DEFINITION
+/****************************************************/
+
+// Statistics of one interrupt vector
+struct VectorStats
+{
+    uint32_t count;                     // number of ISR executions
+    uint64_t cyclesTotal;               // sum of all ISR cycles
+    uint32_t cyclesMax;                 // worst-case ISR cycles
+    uint32_t latencyMax;                // worst-case cycles from pending to vector entry
+    avr_cycle_count_t pendingCycle;     // cycle the vector became pending
+    avr_cycle_count_t entryCycle;       // cycle the vector was entered
+    uint32_t budget;                    // maximum ISR cycles allowed, 0 = no budget
+};
+
+// Declaration of the benchmark struct
+struct IsrBench
+{
+    avr_t *avr;
+    struct VectorStats vectors[VECTORS_MAX];
+    uint32_t latencyBudget;             // maximum interrupt latency allowed, 0 = no budget
+    avr_irq_t *uartInput;
+    avr_irq_t *icpInput;
+    avr_cycle_count_t nextUartCycle;
+    size_t uartIndex;
+    avr_cycle_count_t nextEdgeCycle;
+    uint8_t edgeIndex;
+    uint8_t icpLevel;
+    uint32_t necCode;
+};
+
+/****************************************************/
+// LOCAL STATIC STRUCT VARIABLE DECLARATION, INIT
+/****************************************************/
+
+static struct IsrBench this;
+
+// Vector names of the ATmega328P as used with ISR() without "_vect"
+static const char *const vectorNames[VECTORS_MAX] =
+{
+    "RESET", "INT0", "INT1", "PCINT0", "PCINT1", "PCINT2", "WDT",
+    "TIMER2_COMPA", "TIMER2_COMPB", "TIMER2_OVF", "TIMER1_CAPT", "TIMER1_COMPA",
+    "TIMER1_COMPB", "TIMER1_OVF", "TIMER0_COMPA", "TIMER0_COMPB", "TIMER0_OVF",
+    "SPI_STC", "USART_RX", "USART_UDRE", "USART_TX", "ADC", "EE_READY",
+    "ANALOG_COMP", "TWI", "SPM_READY",
+};
+
+// Typed into the shell over and over: character echo, escape sequences and command output
+static const char uartScript[] = "cd\rdc\rxy\e[D\e[C\x7F\x7F\rrb\rac\r";
+
+/****************************************************/
+// LOCAL FUNCTIONS
+/****************************************************/
+
+// Get the vector number by name, -1 if unknown
+static int findVector(const char *name)
+{
+    for (int i = 0; i < VECTORS_MAX; i++)
+        if (strcmp(vectorNames[i], name) == 0)
+            return i;
+    return -1;
+}
+
+// Read the budget file: one "NAME CYCLES" pair per line, '#' starts a comment
+// Return value:    1: budget file read
+//                  0: file missing or unknown vector name
+static int readBudget(const char *path)
+{
+    char line[128], name[32];
+    unsigned long cycles;
+    FILE *file = fopen(path, "r");
+    if (file == NULL)
+        return 0;
+    while (fgets(line, sizeof(line), file) != NULL)
+    {
+        int vector;
+        if (line[0] == '#' || sscanf(line, "%31s %lu", name, &cycles) != 2)
+            continue;
+        if (strcmp(name, BUDGET_LATENCY) == 0)
+            this.latencyBudget = cycles;
+        else if ((vector = findVector(name)) >= 0)
+            this.vectors[vector].budget = cycles;
+        else
+        {
+            fprintf(stderr, "isrbench: unknown vector in budget file: %s\n", name);
+            fclose(file);
+            return 0;
+        }
+    }
+    fclose(file);
+    return 1;
+}
+
+// Notified when a vector becomes pending or is cleared
+static void onPending(avr_irq_t *irq, uint32_t value, void *param)
+{
+    struct VectorStats *stats = (struct VectorStats *) param;
+    if (value)
+        stats->pendingCycle = this.avr->cycle;
+}
+
+// Notified when a vector is entered (value 1) and left by RETI (value 0)
+static void onRunning(avr_irq_t *irq, uint32_t value, void *param)
+{
+    struct VectorStats *stats = (struct VectorStats *) param;
+    if (value)
+    {
+        uint32_t latency = this.avr->cycle - stats->pendingCycle;
+        stats->entryCycle = this.avr->cycle;
+        if (latency > stats->latencyMax)
+            stats->latencyMax = latency;
+    }
+    else
+    {
+        uint32_t cycles = this.avr->cycle - stats->entryCycle;
+        stats->count++;
+        stats->cyclesTotal += cycles;
+        if (cycles > stats->cyclesMax)
+            stats->cyclesMax = cycles;
+    }
+}
+
+// Get the duration of edge index of a NEC frame in microseconds, 0 at the end of the frame
+// Edges alternate between falling (start of a pulse) and rising (start of a space)
+static uint32_t getNecEdgeDuration(uint8_t index)
+{
+    if (index == 0)
+        return NEC_LEADING_PULSE;
+    if (index == 1)
+        return NEC_LEADING_SPACE;
+    index -= 2;
+    if (index > 64)
+        return 0;
+    if ((index & 1) == 0)
+        return NEC_BIT_PULSE;
+    return (this.necCode >> (index / 2)) & 1 ? NEC_ONE_SPACE : NEC_ZERO_SPACE;
+}
+
+// Inject the next UART byte and the next ICP1 edge when due
+static void injectStimuli()
+{
+    avr_cycle_count_t cycle = this.avr->cycle;
+
+    if (cycle >= this.nextUartCycle)
+    {
+        avr_raise_irq(this.uartInput, (uint8_t) uartScript[this.uartIndex]);
+        this.uartIndex = (this.uartIndex + 1) % (sizeof(uartScript) - 1);
+        this.nextUartCycle = cycle + CYCLES_PER_BYTE;
+    }
+
+    if (cycle >= this.nextEdgeCycle)
+    {
+        uint32_t duration = getNecEdgeDuration(this.edgeIndex);
+        if (duration == 0)
+        {
+            // idle high until the next frame with another code
+            this.icpLevel = 1;
+            this.edgeIndex = 0;
+            this.necCode = this.necCode * 1103515245UL + 12345UL;
+            duration = NEC_FRAME_PERIOD;
+        }
+        else
+        {
+            this.icpLevel = (this.edgeIndex & 1);
+            this.edgeIndex++;
+        }
+        avr_raise_irq(this.icpInput, this.icpLevel);
+        this.nextEdgeCycle = cycle + (avr_cycle_count_t) duration * CYCLES_PER_US;
+    }
+}
+
+// Print the statistics and check the budgets
+// Return value: number of budgets exceeded
+static int report()
+{
+    int exceeded = 0;
+    uint32_t latencyMax = 0;
+
+    printf("%-14s %10s %10s %10s %10s %10s\n", "vector", "count", "mean", "max", "budget", "latency");
+    for (int i = 1; i < VECTORS_MAX; i++)
+    {
+        struct VectorStats *stats = &this.vectors[i];
+        int over = stats->budget && stats->cyclesMax > stats->budget;
+        if (stats->count == 0 && stats->budget == 0)
+            continue;
+        printf("%-14s %10u %10.1f %10u %10u %10u%s\n", vectorNames[i], stats->count,
+            stats->count ? (double) stats->cyclesTotal / stats->count : 0.0,
+            stats->cyclesMax, stats->budget, stats->latencyMax, over ? "  OVER BUDGET" : "");
+        if (stats->latencyMax > latencyMax)
+            latencyMax = stats->latencyMax;
+        exceeded += over;
+    }
+    printf("maximum interrupt latency: %u cycles, budget %u%s\n", latencyMax, this.latencyBudget,
+        this.latencyBudget && latencyMax > this.latencyBudget ? "  OVER BUDGET" : "");
+    exceeded += this.latencyBudget && latencyMax > this.latencyBudget;
+    return exceeded;
+}
+
+/****************************************************/
+// GLOBAL FUNCTIONS
+/****************************************************/
+
+int main(int argc, char **argv)
+{
+    elf_firmware_t firmware;
+    uint32_t flags = 0;
+    unsigned long simulatedMs = argc > 3 ? strtoul(argv[3], NULL, 0) : DEFAULT_MS;
+    avr_cycle_count_t endCycle;
+    int exceeded;
+
+    if (argc < 3)
+    {
+        fprintf(stderr, "usage: %s FIRMWARE.elf BUDGET_FILE [SIMULATED_MS]\n", argv[0]);
+        return 2;
+    }
+    if (!readBudget(argv[2]))
+    {
+        fprintf(stderr, "isrbench: cannot read budget file %s\n", argv[2]);
+        return 2;
+    }
+
+    memset(&firmware, 0, sizeof(firmware));
+    if (elf_read_firmware(argv[1], &firmware) != 0 || (this.avr = avr_make_mcu_by_name(MCU)) == NULL)
+    {
+        fprintf(stderr, "isrbench: cannot load %s for %s\n", argv[1], MCU);
+        return 2;
+    }
+    avr_init(this.avr);
+    avr_load_firmware(this.avr, &firmware);
+    this.avr->frequency = F_CPU;
+
+    // hook all vectors registered by the simulated peripherals
+    for (int i = 0; i < this.avr->interrupts.vector_count; i++)
+    {
+        avr_int_vector_t *vector = this.avr->interrupts.vector[i];
+        if (vector->vector >= VECTORS_MAX)
+            continue;
+        avr_irq_register_notify(vector->irq + AVR_INT_IRQ_PENDING, onPending, &this.vectors[vector->vector]);
+        avr_irq_register_notify(vector->irq + AVR_INT_IRQ_RUNNING, onRunning, &this.vectors[vector->vector]);
+    }
+
+    // keep the shell output off the console, it is not needed for the cycle counts
+    avr_ioctl(this.avr, AVR_IOCTL_UART_GET_FLAGS('0'), &flags);
+    flags &= ~AVR_UART_FLAG_STDIO;
+    avr_ioctl(this.avr, AVR_IOCTL_UART_SET_FLAGS('0'), &flags);
+
+    this.uartInput = avr_io_getirq(this.avr, AVR_IOCTL_UART_GETIRQ('0'), UART_IRQ_INPUT);
+    this.icpInput = avr_io_getirq(this.avr, AVR_IOCTL_TIMER_GETIRQ('1'), TIMER_IRQ_IN_ICP);
+    this.icpLevel = 1;
+    this.necCode = 0x00FF30CFUL;
+    // leave time for the welcome text before typing
+    this.nextUartCycle = F_CPU / 10;
+    this.nextEdgeCycle = F_CPU / 10;
+
+    endCycle = (avr_cycle_count_t) simulatedMs * (F_CPU / 1000UL);
+    while (this.avr->cycle < endCycle)
+    {
+        int state = avr_run(this.avr);
+        if (state == cpu_Done || state == cpu_Crashed)
+        {
+            fprintf(stderr, "isrbench: simulation stopped at cycle %llu\n", (unsigned long long) this.avr->cycle);
+            return 2;
+        }
+        injectStimuli();
+    }
+
+    printf("isrbench: %s, %lu ms simulated at %lu MHz\n", argv[1], simulatedMs, F_CPU / 1000000UL);
+    exceeded = report();
+    if (exceeded)
+        printf("FAILED: %d budget(s) exceeded\n", exceeded);
+    else
+        printf("PASSED\n");
+    return exceeded ? 1 : 0;
+}
@@ -0,0 +1,25 @@
+# ISR cycle budget check on the simavr simulator: pio run -e uno -t isrbench
+# Builds tools/isrbench/isrbench.c for the host and runs it on the firmware ELF.
+# SIMAVR_CFLAGS and SIMAVR_LIBS override the compiler and linker flags of simavr,
+# ISRBENCH_MS the simulated time in milliseconds.
+
+Import("env")
+
+import os
+
+tool_dir = os.path.join(env.subst("$PROJECT_DIR"), "tools", "isrbench")
+tool = os.path.join(env.subst("$BUILD_DIR"), "isrbench")
+cflags = os.environ.get("SIMAVR_CFLAGS", "")
+libs = os.environ.get("SIMAVR_LIBS", "-lsimavr -lelf")
+simulated_ms = os.environ.get("ISRBENCH_MS", "2000")
+
+env.AddCustomTarget(
+    name="isrbench",
+    dependencies="$BUILD_DIR/${PROGNAME}.elf",
+    actions=[
+        "cc -O2 %s -o %s %s %s" % (cflags, tool, os.path.join(tool_dir, "isrbench.c"), libs),
+        "%s $BUILD_DIR/${PROGNAME}.elf %s %s" % (tool, os.path.join(tool_dir, "budget.txt"), simulated_ms),
+    ],
+    title="ISR budget",
+    description="Run the firmware in simavr and check the ISR cycle budgets",
+)